@@ -87,27 +87,16 @@ uspell_checker_get_dictionary_dirs (EnchantBroker * broker)
 	return dirs;
 }
 
+// The rest of a check, for a word not spelled right as it is, specialized
+// for the traits of the language so that it has no tests of the flags.
+template <bool upperLower, bool hasComposition, bool hasCompounds>
 static int
-uspell_dict_check (EnchantDict * me, const char *const word, size_t len)
+uspell_check_as (uSpell *manager, const utf8_t *myWord, wide_t *curBuf,
+		 wide_t *otherBuf, int length)
 {
-	uSpell *manager;
-	wide_t buf1[MAXCHARS], buf2[MAXCHARS], *curBuf, *otherBuf, *tmpBuf;
-	utf8_t myWord[MAXCHARS];
-	int length;
-	
-	if (len >= MAXCHARS)
-		return 1; // too long; can't be right
-	memcpy(reinterpret_cast<char *>(myWord), word, len);
-	myWord[len] = 0;
-	curBuf = buf1;
-	otherBuf = buf2;
-	manager = reinterpret_cast<uSpell *>(me->user_data);
+	wide_t *tmpBuf;
 
-	length = utf8_wide(curBuf, myWord, MAXCHARS);
-	if (manager->isSpelledRight(curBuf, length)) {
-		return 0; // correct the first time
-	}
-	if (manager->theFlags & uSpell::upperLower) {
+	if (upperLower) {
 		toUpper(otherBuf, curBuf, length);
 		if (manager->isSpelledRight(otherBuf, length)) {
 			manager->acceptWord(myWord);
@@ -117,7 +106,7 @@ uspell_dict_check (EnchantDict * me, const char *const word, size_t len)
 		curBuf = otherBuf;
 		otherBuf = tmpBuf;
 	}
-	if (manager->theFlags & uSpell::hasComposition) {
+	if (hasComposition) {
 		unPrecompose(otherBuf, &length, curBuf, length);
 		if (manager->isSpelledRight(otherBuf, length)) {
 			manager->acceptWord(myWord);
@@ -127,7 +116,7 @@ uspell_dict_check (EnchantDict * me, const char *const word, size_t len)
 		curBuf = otherBuf;
 		otherBuf = tmpBuf;
 	}
-	if (manager->theFlags & uSpell::hasCompounds) {
+	if (hasCompounds) {
 		if (manager->isSpelledRightMultiple(curBuf, length)) {
 			manager->acceptWord(myWord);
 			return 0; // correct as two words.  Not right for all languages.
@@ -136,6 +125,48 @@ uspell_dict_check (EnchantDict * me, const char *const word, size_t len)
 	return 1;
 }
 
+typedef int (*uspell_checker_t) (uSpell *manager, const utf8_t *myWord,
+				 wide_t *curBuf, wide_t *otherBuf, int length);
+
+// indexed by upperLower + 2*hasComposition + 4*hasCompounds
+static const uspell_checker_t uspell_checkers[8] = {
+	uspell_check_as<false, false, false>, uspell_check_as<true, false, false>,
+	uspell_check_as<false, true, false>, uspell_check_as<true, true, false>,
+	uspell_check_as<false, false, true>, uspell_check_as<true, false, true>,
+	uspell_check_as<false, true, true>, uspell_check_as<true, true, true>,
+};
+
+static uspell_checker_t
+uspell_checker_for (const char flags)
+{
+	return uspell_checkers[((flags & uSpell::upperLower) ? 1 : 0) +
+		((flags & uSpell::hasComposition) ? 2 : 0) +
+		((flags & uSpell::hasCompounds) ? 4 : 0)];
+}
+
+static int
+uspell_dict_check (EnchantDict * me, const char *const word, size_t len)
+{
+	uSpell *manager;
+	wide_t buf1[MAXCHARS], buf2[MAXCHARS];
+	utf8_t myWord[MAXCHARS];
+	int length;
+	
+	if (len >= MAXCHARS)
+		return 1; // too long; can't be right
+	manager = reinterpret_cast<uSpell *>(me->user_data);
+	if (manager->isSpelledRight(reinterpret_cast<const utf8_t *>(word), len))
+		return 0; // correct the first time; nothing converted
+	memcpy(reinterpret_cast<char *>(myWord), word, len);
+	myWord[len] = 0;
+
+	length = utf8_wide(buf1, myWord, len, MAXCHARS, NULL);
+	if (length < 0)
+		return -1; // not valid UTF-8
+	return uspell_checker_for(manager->theFlags) (manager, myWord, buf1, buf2,
+						      length);
+}
+
 static char **
 uspell_dict_suggest (EnchantDict * me, const char *const word,
 		     size_t len, size_t * out_n_suggs)
@@ -156,9 +187,13 @@ uspell_dict_suggest (EnchantDict * me, const char *const word,
 	myWord[len] = 0;
 	manager = reinterpret_cast<uSpell *>(me->user_data);
 	
+	length = utf8_wide(buf, myWord, len, MAXCHARS, NULL);
+	if (length < 0) { // not valid UTF-8
+		*out_n_suggs = 0;
+		return NULL;
+	}
 	list = reinterpret_cast<utf8_t **>(
 					   calloc(sizeof(char *), MAXALTERNATIVE));
-	length = utf8_wide(buf, myWord, MAXCHARS);
 	*out_n_suggs = manager->showAlternatives(buf, length,
 						 list, MAXALTERNATIVE);
 	
@@ -199,7 +234,8 @@ uspell_dict_add_to_session (EnchantDict * me, const char *const word,
 		if (g_unichar_isupper(buf[index])) return; // case-sensitive word
 		buf[index] = g_unichar_toupper(buf[index]);
 	}
-	wide_utf8(myWord, MAXCHARS, buf, length);
+	if (wide_utf8(myWord, MAXCHARS, buf, length) < 0)
+		return; // the upper-case form doesn't fit
 	manager->acceptWord(myWord);
 } // uspell_dict_add_to_session
 
@@ -254,7 +290,7 @@ s_buildHashNames (std::vector<std::string> & names, EnchantBroker * broker, cons
 static uSpell *
 uspell_request_dict (const char * base, const char * mapping, const int flags)
 {
-	char *fileName, *transName, *filePart, *transPart;
+	char *fileName, *transName, *imageName, *filePart, *transPart, *imagePart;
 
 	uSpell *manager;
 
@@ -263,20 +299,36 @@ uspell_request_dict (const char * base, const char * mapping, const int flags)
 
 	filePart =  g_strconcat(mapping, ".uspell.dat", NULL);
 	transPart =  g_strconcat(mapping, ".uspell.trans", NULL);
+	imagePart =  g_strconcat(mapping, ".uspell.img", NULL);
 	fileName = g_build_filename (base, filePart, NULL);
 	transName = g_build_filename (base, transPart, NULL);
+	imageName = g_build_filename (base, imagePart, NULL);
 	g_free(filePart);	
 	g_free(transPart);	
+	g_free(imagePart);	
 
 	try {
-		manager = new uSpell(fileName, transName, flags);
-	} 
+		manager = new uSpell(imageName, transName); // precompiled, if present
+		if (manager->theFlags != flags) { // compiled for other flags
+			delete manager;
+			manager = NULL;
+		}
+	}
 	catch (...) {
 		manager = NULL;
 	}
+	if (manager == NULL) {
+		try {
+			manager = new uSpell(fileName, transName, flags);
+		} 
+		catch (...) {
+			manager = NULL;
+		}
+	}
 
 	g_free (fileName);
 	g_free (transName);
+	g_free (imageName);
 
 	return manager;
 }
@@ -0,0 +1,243 @@
+// bench.cpp: measure the speed of the uspell package.
+// Usage: ubench wordfile transcribefile [misspellings]
+//
+//	wordfile is a dictionary file; each word terminated by \n.
+//	transcribefile is a file of "sounds like" for helping find
+//		close-sounding suggestions for misspelled words.  It may be "".
+//	misspellings is how many misspelled words to ask for alternatives
+//		(default 2000).
+//
+// Output: the time to build the tables, the rate of isSpelledRight() on every
+// word of wordfile, both converted to wide_t and as UTF-8, the time to
+// reduce every word with reduce(), which tests the traits of the language,
+// and with the reducer specialized for them, the time per showAlternatives()
+// on misspellings made by deterministically deleting or transposing letters
+// of dictionary words, one or two edits each, with the share of them whose
+// word is among the first four alternatives, and the statistics of the
+// tables; then the same ranked by rankByEdits(), with the trie engine, with
+// suggestWithin(2), and for a speller built with twoDeletions, after the
+// time it takes to build its index.
+//
+// "make bench" runs it on the dictionaries in ../dic.
+//
+// license: Gnu Public License.
+
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "uspell.h"
+#include "utf8convert.h"
+#include "image.h"
+#include "uniprops.h"
+#include "transcribe.h"
+
+#define MAXALTERNATIVE 4
+#define ROUNDS 5 // best of, for the reducers
+
+static double now() {
+	struct timespec theTime;
+	clock_gettime(CLOCK_MONOTONIC, &theTime);
+	return(theTime.tv_sec + theTime.tv_nsec / 1e9);
+} // now
+
+// Time showAlternatives() on misspellings of every so many words of the
+// dictionary text[..end), with one or two edits each: alternately the middle
+// letter dropped or the middle two transposed, and with two edits, also the
+// letter after the middle dropped.
+static void timeAlternatives(uSpell *mySpeller, const char *label,
+		const utf8_t *text, const utf8_t *end, const int wordCount,
+		const int misspellings, const int edits) {
+	const utf8_t *word, *next;
+	utf8_t wordBuf[BUFLEN];
+	wide_t bigBuf[BUFLEN];
+	utf8_t *list[MAXALTERNATIVE];
+	int length, done, found, recalled, index, count;
+	double start, elapsed;
+	done = found = recalled = 0;
+	start = now();
+	for (word = text, index = 0; word < end && done < misspellings;
+			word = next + 1, index += 1) {
+		next = reinterpret_cast<const utf8_t *>(
+			memchr(word, '\n', end - word));
+		if (next == NULL) next = end;
+		if (next - word < 3 || next - word >= BUFLEN) continue;
+		if (index % (wordCount / misspellings + 1)) continue;
+		memcpy(wordBuf, word, next - word);
+		wordBuf[next - word] = 0;
+		length = utf8_wide(bigBuf, wordBuf, BUFLEN);
+		if (length < 2 + edits) continue;
+		if (done & 1) { // transpose the middle two
+			wide_t save = bigBuf[length/2];
+			bigBuf[length/2] = bigBuf[length/2 - 1];
+			bigBuf[length/2 - 1] = save;
+		} else { // drop the middle one
+			memmove(bigBuf + length/2, bigBuf + length/2 + 1,
+				(length - length/2 - 1) * sizeof(wide_t));
+			length -= 1;
+		}
+		if (edits == 2) { // drop the one after the middle
+			memmove(bigBuf + length/2 + 1, bigBuf + length/2 + 2,
+				(length - length/2 - 2) * sizeof(wide_t));
+			length -= 1;
+		}
+		count = mySpeller->showAlternatives(bigBuf, length, list,
+			MAXALTERNATIVE);
+		found += count;
+		while (count) { // was the word itself among them?
+			count -= 1;
+			if (!strcmp(reinterpret_cast<char *>(list[count]),
+					reinterpret_cast<char *>(wordBuf))) {
+				recalled += 1;
+			}
+			free(list[count]);
+		}
+		done += 1;
+	}
+	elapsed = now() - start;
+	fprintf(stdout, "%sshowAlternatives, %d edit%s: %d misspellings, %.1f us "
+		"each, %.2f alternatives each, recall %.1f%%\n", label, edits,
+		edits > 1 ? "s" : "", done, done ? elapsed * 1e6 / done : 0.0,
+		done ? static_cast<double>(found) / done : 0.0,
+		done ? 100.0 * recalled / done : 0.0);
+} // timeAlternatives
+
+int main(int argc, char *argv[]) {
+	uSpell *mySpeller;
+	utf8_t *text, *word, *next, *end;
+	size_t textLength, wordsLength;
+	wide_t *words; // converted dictionary words
+	wide_t reduceBuf[BUFLEN];
+	transcriber *myTranscribe;
+	reducer_t reducer;
+	double best[2];
+	long sum; // of reduced lengths, so reducing isn't optimized away
+	utf8_t *list[MAXALTERNATIVE];
+	int length, wordCount, goodCount, misspellings, index, round, count;
+	double start, elapsed;
+	if (argc != 3 && argc != 4) {
+		fprintf(stdout, "Usage: %s wordfile transcribefile [misspellings]\n",
+			argv[0]);
+		exit(1);
+	}
+	misspellings = argc == 4 ? atoi(argv[3]) : 2000;
+	start = now();
+	try {
+		mySpeller = new uSpell(argv[1], argv[2], 0);
+	}
+	catch (...) {
+		fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[1]);
+		exit(1);
+	}
+	fprintf(stdout, "construct: %.3f s\n", now() - start);
+	text = reinterpret_cast<utf8_t *>(mapFile(argv[1], &textLength));
+	if (text == NULL) {
+		perror(argv[1]);
+		exit(1);
+	}
+	end = text + textLength;
+	// every dictionary word should be spelled right.  Convert them first,
+	// each as its length and then its characters, so we time only the check.
+	words = reinterpret_cast<wide_t *>(
+		malloc((textLength + 1) * sizeof(wide_t)));
+	if (words == NULL) {
+		perror(argv[0]);
+		exit(1);
+	}
+	wordsLength = wordCount = 0;
+	for (word = text; word < end; word = next + 1) {
+		next = reinterpret_cast<utf8_t *>(memchr(word, '\n', end - word));
+		if (next == NULL) next = end;
+		if (next == word || next - word >= BUFLEN) continue;
+		length = utf8_wide(words + wordsLength + 1, word, next - word, BUFLEN);
+		words[wordsLength] = length;
+		wordsLength += length + 1;
+		wordCount += 1;
+	}
+	goodCount = 0;
+	start = now();
+	for (index = 0; static_cast<size_t>(index) < wordsLength;
+			index += words[index] + 1) {
+		if (mySpeller->isSpelledRight(words + index + 1, words[index]))
+			goodCount += 1;
+	}
+	elapsed = now() - start;
+	fprintf(stdout, "isSpelledRight: %d of %d words, %.0f ns/word\n",
+		goodCount, wordCount, wordCount ? elapsed * 1e9 / wordCount : 0.0);
+	// reduce them as the speller does, both ways
+	myTranscribe = new transcriber(argv[2]);
+	reducer = reducerFor(false, myTranscribe->hasRules());
+	best[0] = best[1] = 1e9;
+	sum = 0;
+	for (round = 0; round < ROUNDS; round += 1) {
+		start = now();
+		for (index = 0; static_cast<size_t>(index) < wordsLength;
+				index += words[index] + 1) {
+			reduce(reduceBuf, &length, words + index + 1, words[index],
+				myTranscribe, false);
+			sum += length;
+		}
+		if (now() - start < best[0]) best[0] = now() - start;
+		start = now();
+		for (index = 0; static_cast<size_t>(index) < wordsLength;
+				index += words[index] + 1) {
+			reducer(reduceBuf, &length, words + index + 1, words[index],
+				myTranscribe);
+			sum += length;
+		}
+		if (now() - start < best[1]) best[1] = now() - start;
+	}
+	fprintf(stdout, "reduce: %.1f ns/word; specialized: %.1f ns/word "
+		"(%ld)\n", wordCount ? best[0] * 1e9 / wordCount : 0.0,
+		wordCount ? best[1] * 1e9 / wordCount : 0.0, sum);
+	delete myTranscribe;
+	free(words);
+	// the same words as they are in the file
+	goodCount = 0;
+	start = now();
+	for (word = text; word < end; word = next + 1) {
+		next = reinterpret_cast<utf8_t *>(memchr(word, '\n', end - word));
+		if (next == NULL) next = end;
+		if (next == word || next - word >= BUFLEN) continue;
+		if (mySpeller->isSpelledRight(word, next - word)) goodCount += 1;
+	}
+	elapsed = now() - start;
+	fprintf(stdout, "isSpelledRight (UTF-8): %d of %d words, %.0f ns/word\n",
+		goodCount, wordCount, wordCount ? elapsed * 1e9 / wordCount : 0.0);
+	timeAlternatives(mySpeller, "", text, end, wordCount, misspellings, 1);
+	timeAlternatives(mySpeller, "", text, end, wordCount, misspellings, 2);
+	mySpeller->reportStatistics(stdout);
+	// again ranked by edit distance
+	mySpeller->rankByEdits(true);
+	timeAlternatives(mySpeller, "rankByEdits ", text, end, wordCount,
+		misspellings, 1);
+	timeAlternatives(mySpeller, "rankByEdits ", text, end, wordCount,
+		misspellings, 2);
+	mySpeller->rankByEdits(false);
+	// and with the trie engine
+	start = now();
+	mySpeller->suggestWithin(2);
+	fprintf(stdout, "trie construct: %.3f s\n", now() - start);
+	timeAlternatives(mySpeller, "trie ", text, end, wordCount, misspellings,
+		1);
+	timeAlternatives(mySpeller, "trie ", text, end, wordCount, misspellings,
+		2);
+	mySpeller->reportStatistics(stdout);
+	delete mySpeller;
+	// again with the two-deletion index
+	start = now();
+	mySpeller = new uSpell(argv[1], argv[2], uSpell::twoDeletions);
+	fprintf(stdout, "twoDeletions construct: %.3f s\n", now() - start);
+	start = now(); // the first misspelling builds the index
+	count = mySpeller->showAlternatives(
+		reinterpret_cast<const utf8_t *>("QQQXZ"), 5, list, MAXALTERNATIVE);
+	while (count) free(list[--count]);
+	fprintf(stdout, "twoDeletions index construct: %.3f s\n", now() - start);
+	timeAlternatives(mySpeller, "twoDeletions ", text, end, wordCount,
+		misspellings, 1);
+	timeAlternatives(mySpeller, "twoDeletions ", text, end, wordCount,
+		misspellings, 2);
+	mySpeller->reportStatistics(stdout);
+	delete mySpeller;
+	unmapFile(text, textLength);
+	return(0);
+} // main
@@ -0,0 +1,55 @@
+// compile.cpp: build a precompiled image of a uspell dictionary.
+// Usage: uspell-compile wordfile transcribefile flags imagefile
+//        uspell-compile --verify imagefile
+//
+//	wordfile is a dictionary file; each word terminated by \n.
+//	transcribefile is a file of "sounds like" for helping find
+//		close-sounding suggestions for misspelled words.  It may be "".
+//	flags is the sum of the uSpell initializer flags to build with:
+//		1 expandPrecomposed, 2 upperLower, 4 hasCompounds, 8 hasComposition
+//		16 exactMembership, 32 multiplyHash, 64 twoDeletions
+//	imagefile is the file to write.
+//
+// The image can then be given to the image initializer of uSpell, together
+// with the same transcribefile.  With --verify, the image is instead checked
+// whole, which the initializer doesn't do; the exit status is 1 if it is
+// damaged.
+//
+// license: Gnu Public License.
+
+#include <stdlib.h>
+#include <string.h>
+#include "uspell.h"
+#include "image.h"
+
+int main(int argc, char *argv[]) {
+	uSpell *mySpeller;
+	if (argc == 3 && !strcmp(argv[1], "--verify")) {
+		if (!verifyImage(argv[2])) {
+			fprintf(stderr, "%s: %s is damaged\n", argv[0], argv[2]);
+			exit(1);
+		}
+		fprintf(stdout, "%s is intact\n", argv[2]);
+		return(0);
+	}
+	if (argc != 5) {
+		fprintf(stdout,
+			"Usage: %s wordfile transcribefile flags imagefile\n"
+			"       %s --verify imagefile\n",
+			argv[0], argv[0]);
+		exit(1);
+	}
+	try {
+		mySpeller = new uSpell(argv[1], argv[2], atoi(argv[3]));
+	}
+	catch (...) {
+		fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[1]);
+		exit(1);
+	}
+	if (!mySpeller->writeImage(argv[4])) {
+		fprintf(stderr, "%s: cannot write %s\n", argv[0], argv[4]);
+		exit(1);
+	}
+	delete mySpeller;
+	return(0);
+} // main
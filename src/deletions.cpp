@@ -0,0 +1,316 @@
+// deletions.cpp
+// license: Gnu Public License.
+//
+// The deletion engine for suggestions, used with the twoDeletions flag.  The
+// reducedWordTable holds each word under its reduced form with at most one
+// code omitted, so the hash engine finds only words that share such a form
+// with the misspelling.  Omitting up to two codes from both sides finds
+// every word within two edits: an insertion, omission or replacement, or a
+// transposition of adjacent codes, is undone by omitting at most one code
+// from each side, and no code is edited twice.  So the engine indexes the
+// reduced form of each word with 0, 1 or 2 codes omitted, looks up the
+// misspelling's forms likewise, and ranks what it finds by edit distance,
+// dropping those more than maxEdits away; the words left are exactly those
+// within maxEdits.  Of words as close, those wordDiff() finds closer go
+// first, scaled by trieTieScale as the trie engine scores them.
+//
+// The index is separate from the reducedWordTable.  Each entry is the high
+// half of the hash of one omitted form (its check) and the id of the word it
+// comes from; each distinct form of a word is entered once.  Entries are
+// grouped in buckets by the low bits of the hash, about bucketEntries in
+// each, and sorted within a bucket by check and then id, with duplicates
+// dropped, so the entries of one form are a posting list of word ids, in
+// dictionary order, and a lookup reads one bucket.  An entry takes 6 bytes.
+// A word of n codes has at most 1 + n + n(n-1)/2 forms, so long words cost
+// the most; the index takes the words by increasing length while they fit in
+// deletionLimit bytes, and records the longest it took in deletionLength.  A
+// misspelling that could be within two edits of a longer word is left to the
+// hash engine.
+//
+// The index is built from the word columns the first time a misspelling
+// needs it, so an image needs nothing more.  Words added later are compared
+// one by one until there are an eighth as many as the index has; then it is
+// built again.  Removed words stay in it until then, and are skipped.
+//
+// 	uniqueSort: sort and drop repeats
+// 	uSpell::omissionHashes: the hashes of a reduced form's omitted forms
+// 	uSpell::limitTwoDeletions: bounds the index
+// 	uSpell::buildDeletions, uSpell::freeDeletions, uSpell::deletionsCover:
+// 		building
+// 	uSpell::deletionAlternatives: suggestions
+
+#include <string.h>
+#include <stdlib.h>
+#include "uspell.h"
+#include "rollhash.h"
+
+static const int bucketEntries = 8; // entries per bucket, about
+static const int formRoom = 1 + uSpell::twoDeletionLength +
+	uSpell::twoDeletionLength * (uSpell::twoDeletionLength - 1) / 2;
+	// forms of a reduced form of twoDeletionLength codes, omitting 0, 1 or 2
+
+static int compareValues(const void *a, const void *b) {
+	__uint32_t first = *reinterpret_cast<const __uint32_t *>(a);
+	__uint32_t second = *reinterpret_cast<const __uint32_t *>(b);
+	return(first < second ? -1 : first > second);
+} // compareValues
+
+static int compareEntries(const void *a, const void *b) {
+	__uint64_t first = *reinterpret_cast<const __uint64_t *>(a);
+	__uint64_t second = *reinterpret_cast<const __uint64_t *>(b);
+	return(first < second ? -1 : first > second);
+} // compareEntries
+
+// Sort values[0..count-1] and drop repeats; return how many are left.
+static int uniqueSort(__uint32_t *values, const int count) {
+	int from, to;
+	if (count < 2) return(count);
+	qsort(values, count, sizeof(values[0]), compareValues);
+	for (from = to = 1; from < count; from += 1) {
+		if (values[from] != values[to-1]) values[to++] = values[from];
+	}
+	return(to);
+} // uniqueSort
+
+// The buckets for an index of entries entries, a power of 2.
+static int bucketsFor(const size_t entries) {
+	int buckets = 1;
+	while (static_cast<size_t>(buckets) * bucketEntries < entries) {
+		buckets <<= 1;
+	}
+	return(buckets);
+} // bucketsFor
+
+// The bytes an index of entries entries takes.
+static size_t indexBytes(const size_t entries) {
+	return(entries * (sizeof(__uint16_t) + sizeof(__uint32_t)) +
+		(bucketsFor(entries) + 1) * sizeof(__uint32_t));
+} // indexBytes
+
+// Set hashes[] to the rollHash() of the reduced form codes, of length codes,
+// with 0, 1 and 2 codes omitted, and return how many there are.  Omissions
+// from a run of equal codes give equal forms, which are not dropped here.
+// length is at most twoDeletionLength.
+int uSpell::omissionHashes(const unsigned char *codes, const int length,
+		__uint32_t *hashes) {
+	wide_t string[twoDeletionLength];
+	int index, count;
+	memset(string, 0, sizeof(string)); // quiets the compiler if length is 0
+	for (index = 0; index < length; index += 1) string[index] = codes[index];
+	hashes[0] = variantHashes(string, length, hashBackend, hashes + 1, NULL);
+	count = 1 + length;
+	if (length >= 2) {
+		count += omissionPairHashes(string, length, hashBackend,
+			hashes + count);
+	}
+	return(count);
+} // omissionHashes
+
+void uSpell::limitTwoDeletions(const size_t bytes) {
+	deletionLimit = bytes;
+	freeDeletions(); // built again within the limit when next needed
+} // limitTwoDeletions
+
+void uSpell::freeDeletions() {
+	free(deletionBuckets);
+	free(deletionChecks);
+	free(deletionIds);
+	deletionBuckets = NULL;
+	deletionChecks = NULL;
+	deletionIds = NULL;
+	deletionCount = 0;
+	deletionIndexed = 0;
+	deletionLength = -1;
+} // freeDeletions
+
+// Build the index from the words we have, as long a prefix of them by length
+// as fits in deletionLimit.
+void uSpell::buildDeletions() {
+	size_t lengthEntries[twoDeletionLength+1], entries;
+	__uint32_t hashes[formRoom], position, end, to;
+	__uint64_t *sorting;
+	__uint16_t *shrunkChecks;
+	wordId_t *shrunkIds;
+	int length, buckets, bucket, count, index, largest;
+	wordId_t wordId;
+	freeDeletions();
+	// the entries of the words of each length, at most
+	memset(lengthEntries, 0, sizeof(lengthEntries));
+	for (wordId = 1; wordId < wordCount; wordId += 1) {
+		length = reducedLengths[wordId];
+		if (length > twoDeletionLength || wordOffsets[wordId] == removedWord)
+			continue;
+		lengthEntries[length] += 1 + length + length * (length - 1) / 2;
+	}
+	entries = 0;
+	for (length = 0; length <= twoDeletionLength; length += 1) {
+		if (indexBytes(entries + lengthEntries[length]) > deletionLimit) break;
+		entries += lengthEntries[length];
+	}
+	deletionLength = length - 1;
+	buckets = bucketsFor(entries);
+	deletionBucketMask = buckets - 1;
+	deletionBuckets = reinterpret_cast<__uint32_t *>(
+		calloc(buckets + 1, sizeof(__uint32_t)));
+	if (deletionBuckets == NULL) throw(noMem);
+	// count the entries of each bucket, and find where each bucket ends
+	for (wordId = 1; wordId < wordCount; wordId += 1) {
+		length = reducedLengths[wordId];
+		if (length > deletionLength || wordOffsets[wordId] == removedWord)
+			continue;
+		count = omissionHashes(reducedBlob + reducedStarts[wordId], length,
+			hashes);
+		for (index = 0; index < count; index += 1) {
+			deletionBuckets[hashes[index] & deletionBucketMask] += 1;
+		}
+	}
+	largest = 0;
+	for (bucket = 0; bucket < buckets; bucket += 1) {
+		if (static_cast<int>(deletionBuckets[bucket]) > largest)
+			largest = deletionBuckets[bucket];
+		if (bucket) deletionBuckets[bucket] += deletionBuckets[bucket-1];
+	}
+	deletionCount = deletionBuckets[buckets] = deletionBuckets[buckets-1];
+	deletionChecks = reinterpret_cast<__uint16_t *>(
+		malloc((deletionCount + 1) * sizeof(__uint16_t)));
+	deletionIds = reinterpret_cast<wordId_t *>(
+		malloc((deletionCount + 1) * sizeof(wordId_t)));
+	sorting = reinterpret_cast<__uint64_t *>(
+		malloc((largest + 1) * sizeof(__uint64_t)));
+	if (deletionChecks == NULL || deletionIds == NULL || sorting == NULL) {
+		free(sorting);
+		freeDeletions();
+		throw(noMem);
+	}
+	// fill each bucket from its end, which leaves deletionBuckets at the
+	// starts
+	for (wordId = 1; wordId < wordCount; wordId += 1) {
+		length = reducedLengths[wordId];
+		if (length > deletionLength || wordOffsets[wordId] == removedWord)
+			continue;
+		count = omissionHashes(reducedBlob + reducedStarts[wordId], length,
+			hashes);
+		for (index = 0; index < count; index += 1) {
+			position = --deletionBuckets[hashes[index] & deletionBucketMask];
+			deletionChecks[position] = hashes[index] >> 16;
+			deletionIds[position] = wordId;
+		}
+	}
+	// sort each bucket by check and id, dropping duplicates: equal forms of
+	// one word, and the rare forms that differ but hash alike in both halves,
+	// which one entry finds as well
+	to = 0;
+	for (bucket = 0; bucket < buckets; bucket += 1) {
+		position = deletionBuckets[bucket];
+		end = deletionBuckets[bucket+1];
+		deletionBuckets[bucket] = to;
+		count = 0;
+		for (; position < end; position += 1) {
+			sorting[count++] = (static_cast<__uint64_t>(
+				deletionChecks[position]) << 32) | deletionIds[position];
+		}
+		qsort(sorting, count, sizeof(sorting[0]), compareEntries);
+		for (index = 0; index < count; index += 1) {
+			if (index && sorting[index] == sorting[index-1]) continue;
+			deletionChecks[to] = sorting[index] >> 32;
+			deletionIds[to] = sorting[index] & 0xffffffff;
+			to += 1;
+		}
+	}
+	deletionBuckets[buckets] = deletionCount = to;
+	free(sorting);
+	// give back the room of the duplicates, if the allocator will
+	shrunkChecks = reinterpret_cast<__uint16_t *>(realloc(deletionChecks,
+		(deletionCount + 1) * sizeof(__uint16_t)));
+	if (shrunkChecks != NULL) deletionChecks = shrunkChecks;
+	shrunkIds = reinterpret_cast<wordId_t *>(realloc(deletionIds,
+		(deletionCount + 1) * sizeof(wordId_t)));
+	if (shrunkIds != NULL) deletionIds = shrunkIds;
+	deletionIndexed = wordCount;
+} // buildDeletions
+
+// Return whether the index finds every word within maxEdits of a reduced
+// misspelling of length codes, building it first if it is missing or if too
+// many words have been added since it was built.
+bool uSpell::deletionsCover(const int length) {
+	if (deletionBuckets == NULL ||
+			(wordCount - deletionIndexed) * 8 > deletionIndexed) {
+		buildDeletions();
+	}
+	return(length + maxEdits <= deletionLength);
+} // deletionsCover
+
+// Add to suggestions[] the words within maxEdits of the target, which
+// deletionsCover().
+void uSpell::deletionAlternatives(const target_t *target) {
+	__uint32_t hashes[formRoom], position, end, check;
+	wordId_t *candidates, *newCandidates, batch[candidateRoom], wordId;
+	int scores[candidateRoom], keyCount, count, room, batchCount, key,
+		index, tie, difference;
+	room = 256;
+	candidates = reinterpret_cast<wordId_t *>(
+		malloc(room * sizeof(wordId_t)));
+	if (candidates == NULL) throw(noMem);
+	count = 0;
+	// the posting lists of the target's forms
+	keyCount = omissionHashes(target->codes, target->length, hashes);
+	for (key = 0; key < keyCount; key += 1) {
+		check = hashes[key] >> 16;
+		position = deletionBuckets[hashes[key] & deletionBucketMask];
+		end = deletionBuckets[(hashes[key] & deletionBucketMask) + 1];
+		for (; position < end && deletionChecks[position] <= check;
+				position += 1) {
+			if (deletionChecks[position] < check) continue;
+			if (count == room) {
+				newCandidates = reinterpret_cast<wordId_t *>(
+					realloc(candidates, 2 * room * sizeof(wordId_t)));
+				if (newCandidates == NULL) {
+					free(candidates);
+					throw(noMem);
+				}
+				candidates = newCandidates;
+				room *= 2;
+			}
+			candidates[count++] = deletionIds[position];
+		}
+	}
+	// and the words added since the index was built
+	for (wordId = deletionIndexed; wordId < wordCount; wordId += 1) {
+		if (count == room) {
+			newCandidates = reinterpret_cast<wordId_t *>(
+				realloc(candidates, 2 * room * sizeof(wordId_t)));
+			if (newCandidates == NULL) {
+				free(candidates);
+				throw(noMem);
+			}
+			candidates = newCandidates;
+			room *= 2;
+		}
+		candidates[count++] = wordId;
+	}
+	// score each once, in id order, so ties go to earlier words
+	count = uniqueSort(candidates, count);
+	for (index = 0; index < count; ) {
+		for (batchCount = 0; index < count && batchCount < candidateRoom;
+				index += 1) {
+			wordId = candidates[index];
+			difference = reducedLengths[wordId] - target->length;
+			if (difference > maxEdits || difference < -maxEdits) {
+				boundedCandidates += 1;
+				continue;
+			}
+			if (wordOffsets[wordId] == removedWord) continue;
+			batch[batchCount++] = wordId;
+		}
+		scoredCandidates += batchCount;
+		editDiffs(target, batch, batchCount, scores);
+		for (key = 0; key < batchCount; key += 1) {
+			if (scores[key] > maxEdits) continue;
+			// of words as close, prefer those wordDiff() finds closer
+			wordDiffs(target, &batch[key], 1, &tie, trieTieScale - 1);
+			if (tie >= trieTieScale) tie = trieTieScale - 1;
+			addSuggestion(batch[key], scores[key] * trieTieScale + tie);
+		}
+	}
+	free(candidates);
+} // deletionAlternatives
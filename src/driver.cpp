@@ -1,7 +1,8 @@
 // driver.cpp: show how to use the uspell package.
 // Usage: driver wordfile transcribefile samplefile supplementalfile
 //
-//	wordfile is a dictionary file; each word terminated by \n.
+//	wordfile is a dictionary file; each word terminated by \n.  It may
+//		instead be an image built by uspell-compile.
 //	transcribefile is a file of "sounds like" for helping find
 //		close-sounding suggestions for misspelled words.
 //	samplefile is a file of words to check spelling of, one per line.
@@ -32,12 +33,13 @@ void treat(utf8_t *word) {
 	// see if the word is spelled right, and if not, print alternatives.
 	int length;
 	wide_t bigBuf[BUFLEN];
-	word[strlen(reinterpret_cast<char *>(word)) -1] = 0; // chomp \n
-	length = utf8_wide(bigBuf, word, BUFLEN);
-	if (mySpeller->isSpelledRight(bigBuf, length)) {
+	length = strlen(reinterpret_cast<char *>(word)) - 1;
+	word[length] = 0; // chomp \n
+	if (mySpeller->isSpelledRight(word, length)) {
 		fprintf(stdout, "%s is ok\n", reinterpret_cast<char *>(word));
 	} else { // spelled wrong
 		wide_t upperBuf[BUFLEN];
+		length = utf8_wide(bigBuf, word, BUFLEN);
 		toUpper(upperBuf, bigBuf, length);
 		if (mySpeller->isSpelledRight(upperBuf, length)) {
 			// fprintf(stdout, "%s is ok once converted to upper case\n",
@@ -80,7 +82,12 @@ int main(int argc, char *argv[]) {
 			argv[0]);
 		exit(1);
 	}
-	mySpeller = new uSpell(argv[1], argv[2], uSpell::expandPrecomposed);
+	try {
+		mySpeller = new uSpell(argv[1], argv[2]); // maybe it's an image
+	}
+	catch (int problem) {
+		mySpeller = new uSpell(argv[1], argv[2], uSpell::expandPrecomposed);
+	}
 	if (*argv[4] && !mySpeller->assimilateFile(argv[4])) {
 		fprintf(stdout, "Failed to assimilate secondary file\n");
 		exit(1);
@@ -0,0 +1,100 @@
+// editdistance.cpp
+// license: Gnu Public License.
+//
+// maskedEditDistance() is Myers' bit-vector algorithm as Hyyrö extended it to
+// transpositions.  The table of edit distances between prefixes of the
+// pattern (the string given by its masks) and of the text is kept one column
+// at a time, as the bits of its vertical differences: bit i of VP is on if
+// row i+1 is one more than row i, and of VN if it is one less.  Each
+// character of the text gives the next column with a dozen operations on
+// those words, and the last row, the distance so far, moves by the
+// horizontal difference at its bit.  A transposition can lower a cell only
+// where the text's previous character matches the pattern's next one and the
+// cell diagonally before it didn't already drop, which D0, the cells equal
+// to their diagonal predecessor, of the previous column tells.  See Hyyrö,
+// "A bit-vector algorithm for computing Levenshtein and Damerau edit
+// distances", 2003.
+//
+// 	editMasks: the pattern's bit for each code
+// 	maskedEditDistance: the bit-parallel distance
+// 	tableDistance, editDistance: the distance by the usual table
+
+#include <string.h>
+#include "myparameters.h"
+#include "editdistance.h"
+
+void editMasks(__uint64_t *masks, const unsigned char *codes,
+		const int length) {
+	int index;
+	memset(masks, 0, 256 * sizeof(masks[0]));
+	for (index = 0; index < length && index < editMaskLength; index += 1) {
+		masks[codes[index]] |= static_cast<__uint64_t>(1) << index;
+	}
+} // editMasks
+
+int maskedEditDistance(const __uint64_t *masks, const int length,
+		const unsigned char *codes, const int codesLength) {
+	__uint64_t positive, negative, same, up, down, match, previous;
+	int index, distance;
+	if (length == 0) return(codesLength);
+	const __uint64_t last = static_cast<__uint64_t>(1) << (length - 1);
+	positive = ~static_cast<__uint64_t>(0); // the first column counts up
+	negative = same = previous = 0;
+	distance = length;
+	for (index = 0; index < codesLength; index += 1) {
+		match = masks[codes[index]];
+		same = (((match & positive) + positive) ^ positive) | match |
+			negative | (((~same & match) << 1) & previous);
+		up = negative | ~(same | positive);
+		down = positive & same;
+		distance += (up & last) != 0;
+		distance -= (down & last) != 0;
+		up = (up << 1) | 1; // the top row counts up
+		down <<= 1;
+		positive = down | ~(same | up);
+		negative = up & same;
+		previous = match;
+	}
+	return(distance);
+} // maskedEditDistance
+
+// The distance by dynamic programming, three rows at a time.  Letters are
+// codes or wide_t characters.
+template <class letter_t>
+static int tableDistance(const letter_t *string1, const int length1,
+		const letter_t *string2, const int length2) {
+	int rows[3][BUFLEN+1], index1, index2, best;
+	int *row, *above, *twoAbove;
+	for (index2 = 0; index2 <= length2; index2 += 1) rows[0][index2] = index2;
+	row = rows[0];
+	above = twoAbove = NULL;
+	for (index1 = 1; index1 <= length1; index1 += 1) {
+		twoAbove = above;
+		above = row;
+		row = rows[index1 % 3];
+		row[0] = index1;
+		for (index2 = 1; index2 <= length2; index2 += 1) {
+			best = above[index2-1] + (string1[index1-1] != string2[index2-1]);
+			if (above[index2] + 1 < best) best = above[index2] + 1;
+			if (row[index2-1] + 1 < best) best = row[index2-1] + 1;
+			if (index1 > 1 && index2 > 1 &&
+					string1[index1-1] == string2[index2-2] &&
+					string1[index1-2] == string2[index2-1] &&
+					twoAbove[index2-2] + 1 < best) {
+				best = twoAbove[index2-2] + 1;
+			}
+			row[index2] = best;
+		}
+	}
+	return(row[length2]);
+} // tableDistance
+
+int editDistance(const unsigned char *codes1, const int length1,
+		const unsigned char *codes2, const int length2) {
+	return(tableDistance(codes1, length1, codes2, length2));
+} // editDistance
+
+int editDistance(const wide_t *string1, const int length1,
+		const wide_t *string2, const int length2) {
+	return(tableDistance(string1, length1, string2, length2));
+} // editDistance
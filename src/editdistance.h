@@ -0,0 +1,32 @@
+// editdistance.h
+// license: Gnu Public License.
+//
+// Edit distance between reduced forms: the fewest insertions, omissions and
+// replacements of characters, and transpositions of adjacent ones, that turn
+// one string into the other, no character edited twice.  Strings of alphabet
+// codes up to 64 long are compared bit-parallel, a machine word per
+// character of the other string; longer ones, and UCS strings, by the usual
+// table.
+
+#ifndef EDITDISTANCE_H
+#define EDITDISTANCE_H
+
+#include "mytypes.h"
+
+static const int editMaskLength = 64; // longest string editMasks() covers
+
+void editMasks(__uint64_t *masks, const unsigned char *codes,
+	const int length);
+	// sets masks[c], for each of the 256 codes c, to have bit i on where
+	// codes[i] is c, for i below length and editMaskLength.
+int maskedEditDistance(const __uint64_t *masks, const int length,
+	const unsigned char *codes, const int codesLength);
+	// the edit distance between codes and the string of length at most
+	// editMaskLength whose editMasks() are masks.
+int editDistance(const unsigned char *codes1, const int length1,
+	const unsigned char *codes2, const int length2);
+int editDistance(const wide_t *string1, const int length1,
+	const wide_t *string2, const int length2);
+	// the edit distance between strings of at most BUFLEN characters.
+
+#endif // EDITDISTANCE_H
@@ -0,0 +1,577 @@
+// goodwords.cpp
+// license: Gnu Public License.
+//
+// The goodWordTable, which tells whether a word is spelled right.  It is a
+// blocked Bloom filter: an array of 512-bit blocks, each one cache line.  One
+// 64-bit hash of a word selects its block, and it is folded by wide
+// multiplication into 9-bit fields, seven at a time, that select the
+// goodProbes bits within the block that the word turns on.  (Double hashing
+// within so small a block gives too few distinct patterns of bits: words
+// whose patterns nearly coincide made false positives four times too
+// common.)  A lookup costs one hash and touches one cache line.  The number of
+// blocks and of probes are chosen from the number of words for a
+// false-positive rate of about 1/goodFalsePositiveOdds.
+//
+// Both tables key a word by its UTF-8 form, of at most BUFLEN-1 characters:
+// the word as the dictionary has it, with precomposed characters expanded if
+// expandPrecomposed.  A probe is never expanded, so only the expanded form is
+// spelled right, and a valid UTF-8 word is its own key: isSpelledRight() on
+// UTF-8 hashes the caller's bytes and converts nothing; a wide_t word is
+// encoded to UTF-8 first.
+//
+// 	wideKey, uSpell::utf8Key, uSpell::wordKey, uSpell::wideWordKey: the
+// 		key of a word
+// 	setGoodBits, testGoodBits: add and look up one word in a table
+// 	falsePositiveRate: the rate for a given load
+// 	uSpell::chooseGoodSize, uSpell::goodLimit, uSpell::reserveGoodWords:
+// 		sizing
+// 	uSpell::addGoodWord, uSpell::startGoodMigration,
+// 		uSpell::migrateGoodWords: adding words, growing
+// 	uSpell::ignoreWord, uSpell::ignoreKey, uSpell::inGoodWordTable,
+// 		uSpell::isSpelledRight, uSpell::falsePositiveRate: the methods that
+// 		use the table
+//
+// With exactMembership, the exactWordTable takes the place of the
+// goodWordTable.  It is a cuckoo hash table of slots, in buckets of
+// exactBucketSlots, one cache line each.  A slot holds the high half of a
+// word's 64-bit hash, the check, and a reference to the word itself, so a
+// lookup confirms each candidate against the stored word and is exact.  A
+// word's first bucket is chosen by its check, and its second is the first
+// XORed with a scramble of the check, so each bucket leads to the other and
+// the table can be rehashed at any size without the words.  A lookup reads
+// the first bucket, the second if need be, and the stored word.
+//
+// 	otherBucket: a word's other bucket
+// 	uSpell::goodKey: the key of a stored word
+// 	uSpell::findExact, uSpell::findExactIn: lookup
+// 	uSpell::placeExact, uSpell::allocateExactWordTable,
+// 		uSpell::startExactMigration, uSpell::migrateExactBuckets,
+// 		uSpell::rebuildExact: insertion, growing
+// 	uSpell::removeWord, uSpell::removeKey: removal
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "uspell.h"
+#include "utf8convert.h"
+#include "uniprops.h"
+#include "lookup2.h"
+#include "wordhash.h"
+
+static const int blockBits = 512; // one cache line
+static const int blockWords = blockBits / 32; // __uint32_t words per block
+static const int fieldsPerFold = 64 / 9;
+static const ub8 foldMultiplier = 0x9fb21c651e98df25ULL;
+
+// Put the key of the wide_t word string into key, of keyRoom+1 bytes, and
+// return its length: its UTF-8 form, cut to BUFLEN-1 characters as
+// utf8_wide() cuts dictionary words.  A string that is not Unicode can't be
+// the key of any UTF-8 word; its key is its own bytes.
+static int wideKey(const wide_t *string, int length, utf8_t *key) {
+	int keyLength;
+	if (length > BUFLEN - 1) length = BUFLEN - 1;
+	keyLength = wide_utf8(key, uSpell::keyRoom + 1, string, length);
+	if (keyLength > 0) return(keyLength - 1); // not counting the null
+	memcpy(key, string, length*sizeof(wide_t));
+	return(length*sizeof(wide_t));
+} // wideKey
+
+// The key of the UTF-8 word string, of *length bytes, which becomes the length
+// of the key, as a probe: precomposed characters are not expanded, so it
+// agrees with wideKey().  Usually string is its own key and is the answer;
+// otherwise the key is built in buffer, of keyRoom+1 bytes.
+const utf8_t *uSpell::utf8Key(const utf8_t *string, int *length,
+		utf8_t *buffer) {
+	wide_t bigBuf[BUFLEN];
+	int count = utf8_count(string, *length), bigLength;
+	if (count >= 0 && count < BUFLEN) {
+		return(string); // valid and not too long
+	}
+	bigLength = utf8_wide(bigBuf, string, *length, BUFLEN);
+	*length = wideKey(bigBuf, bigLength, buffer);
+	return(buffer);
+} // utf8Key
+
+// The key of the UTF-8 dictionary word string, as utf8Key(), but with its
+// precomposed characters expanded if expandPrecomposed.
+const utf8_t *uSpell::wordKey(const utf8_t *string, int *length,
+		utf8_t *buffer) {
+	wide_t bigBuf[BUFLEN];
+	int count = utf8_count(string, *length), bigLength;
+	if (!(theFlags & expandPrecomposed) ||
+			(count >= 0 && count < BUFLEN && count == *length)) {
+		return(utf8Key(string, length, buffer)); // nothing to expand
+	}
+	bigLength = utf8_wide(bigBuf, string, *length, BUFLEN);
+	*length = wideWordKey(bigBuf, bigLength, buffer);
+	return(buffer);
+} // wordKey
+
+// The key of the wide_t dictionary word string, as wideKey(), but with its
+// precomposed characters expanded if expandPrecomposed.  wordKey() and the
+// wide_t removeWord() both come here, so they agree.
+int uSpell::wideWordKey(const wide_t *string, int length, utf8_t *key) {
+	wide_t bigBuf[2*BUFLEN];
+	if (!(theFlags & expandPrecomposed)) return(wideKey(string, length, key));
+	if (length > BUFLEN - 1) length = BUFLEN - 1;
+	unPrecompose(bigBuf, &length, string, length);
+	return(wideKey(bigBuf, length, key));
+} // wideWordKey
+
+// Turn on the bits of the key whose wordHash() is hashValue in table, of
+// mask+1 bits.
+static void setGoodBits(__uint32_t *table, const int mask, const int probes,
+		const ub8 hashValue) {
+	__uint32_t *block = table +
+		((hashValue >> 32) & (mask / blockBits)) * blockWords;
+	ub8 state = hashValue, fields = 0;
+	int probe;
+	for (probe = 0; probe < probes; probe += 1, fields <<= 9) {
+		if (probe % fieldsPerFold == 0) {
+			fields = state = multiplyFold(state, foldMultiplier);
+		}
+		// the top 9 bits select a bit of the block
+		block[fields >> 60] |= 1u << ((fields >> 55) & 0x1f);
+	}
+} // setGoodBits
+
+// Tell whether all the bits of the key whose wordHash() is hashValue are on
+// in table.
+static inline bool testGoodBits(const __uint32_t *table, const int mask,
+		const int probes, const ub8 hashValue) {
+	const __uint32_t *block = table +
+		((hashValue >> 32) & (mask / blockBits)) * blockWords;
+	ub8 state = hashValue, fields = 0;
+	int probe;
+	for (probe = 0; probe < probes; probe += 1, fields <<= 9) {
+		if (probe % fieldsPerFold == 0) {
+			fields = state = multiplyFold(state, foldMultiplier);
+		}
+		if (!(block[fields >> 60] & (1u << ((fields >> 55) & 0x1f))))
+			return(false);
+	}
+	return(true);
+} // testGoodBits
+
+// The chance that a word that was never added is found in a table of blocks
+// blocks holding words words, each with probes bits.  The number of words
+// in a block is Poisson-distributed.
+static double falsePositiveRate(const double words, const int blocks,
+		const int probes) {
+	double mean = words / blocks;
+	double answer = 0.0;
+	int inBlock, first, last;
+	first = static_cast<int>(mean - 12*sqrt(mean) - 20);
+	if (first < 0) first = 0;
+	last = static_cast<int>(mean + 12*sqrt(mean) + 20);
+	for (inBlock = first; inBlock <= last; inBlock += 1) {
+		// the chance of a block having inBlock words, computed in logs so a
+		// large mean doesn't underflow
+		double chance = exp(inBlock * log(mean) - mean - lgamma(inBlock + 1.0));
+		answer += chance * pow(1.0 - pow(1.0 - 1.0/blockBits,
+			static_cast<double>(inBlock) * probes), probes);
+	}
+	return(answer);
+} // falsePositiveRate
+
+// Choose the number of bits (a power of 2) and of probes with which the
+// goodWordTable reaches our false-positive rate with words words.
+void uSpell::chooseGoodSize(const int words, int *bits, int *probes) {
+	int tryProbes;
+	double rate, bestRate;
+	*probes = 1;
+	for (*bits = minTableLength; ; *bits <<= 1) {
+		bestRate = 1.0;
+		for (tryProbes = 1; tryProbes <= maxGoodProbes; tryProbes += 1) {
+			rate = ::falsePositiveRate(words, *bits / blockBits, tryProbes);
+			if (rate < bestRate) {
+				bestRate = rate;
+				*probes = tryProbes;
+			}
+		}
+		if (bestRate * goodFalsePositiveOdds <= 1.0) break;
+	}
+} // chooseGoodSize
+
+// How many words a goodWordTable of bits bits and probes probes can hold
+// before its false-positive rate is several times what we want, and it
+// should grow.
+int uSpell::goodLimit(const int bits, const int probes) {
+	int low, high, middle;
+	low = 0; // rate is good enough
+	high = bits; // rate is too high
+	while (high - low > 1) {
+		middle = low + (high - low) / 2;
+		if (::falsePositiveRate(middle, bits / blockBits, probes) *
+				goodFalsePositiveOdds <= goodGrowthRate) {
+			low = middle;
+		} else {
+			high = middle;
+		}
+	}
+	return(low);
+} // goodLimit
+
+static __uint32_t *allocateGoodBits(const int bits) {
+	void *answer;
+	if (posix_memalign(&answer, blockBits / 8, bits / 8)) {
+		throw(uSpell::noMem);
+	}
+	memset(answer, 0, bits / 8);
+	return(reinterpret_cast<__uint32_t *>(answer));
+} // allocateGoodBits
+
+// Make sure the goodWordTable can take words more words at our
+// false-positive rate.
+void uSpell::reserveGoodWords(const int words) {
+	int bits, probes, length;
+	if (theFlags & exactMembership) { // size for our usual load instead
+		length = minTableLength;
+		while ((length / 8) * 7 < exactWordCount + words) length <<= 1;
+		if (exactWordTable == NULL) {
+			exactWordTable = allocateExactWordTable(length);
+			exactWordTableMask = length - 1;
+			exactWordTableOwned = true;
+		} else if (length > exactWordTableMask + 1) {
+			startExactMigration(length);
+		}
+		return;
+	}
+	chooseGoodSize(goodWordCount + words, &bits, &probes);
+	if (goodWordTable == NULL) {
+		goodWordTable = allocateGoodBits(bits);
+		goodWordTableMask = bits - 1;
+		goodWordTableLength = bits >> 5;
+		goodProbes = probes;
+		goodWordLimit = goodLimit(bits, probes);
+		goodWordTableOwned = true;
+	} else if (bits > goodWordTableMask + 1) {
+		startGoodMigration(bits, probes);
+	}
+} // reserveGoodWords
+
+void uSpell::ignoreWord(const wide_t *string, const int length) {
+	utf8_t key[keyRoom+1];
+	ignoreKey(key, wideKey(string, length, key));
+} // ignoreWord
+
+void uSpell::ignoreKey(const utf8_t *key, const int length) {
+	__uint32_t ref;
+	if ((theFlags & exactMembership) && findExact(key, length))
+		return; // we know it already
+	// remember it, so the goodWordTable can be rebuilt when it grows
+	if (ignoredLength + length + 2 > ignoredRoom) {
+		size_t newRoom = ignoredRoom ? 2*ignoredRoom : 4096;
+		while (newRoom < ignoredLength + length + 2) newRoom *= 2;
+		utf8_t *newWords = reinterpret_cast<utf8_t *>(
+			realloc(ignoredWords, newRoom));
+		if (newWords == NULL) throw(noMem);
+		ignoredWords = newWords;
+		ignoredRoom = newRoom;
+	}
+	ref = ignoredRef | ignoredLength;
+	ignoredWords[ignoredLength] = length & 0xff;
+	ignoredWords[ignoredLength + 1] = length >> 8;
+	memcpy(ignoredWords + ignoredLength + 2, key, length);
+	ignoredLength += length + 2;
+	addGoodWord(key, length, ref);
+} // ignoreKey
+
+// Put the key, whose stored form is ref, in the goodWordTable, and in its
+// replacement if one is being built; or in the exactWordTable.
+void uSpell::addGoodWord(const utf8_t *key, const int length,
+		const __uint32_t ref) {
+	int bits, probes;
+	ub8 hashValue = wordHash(key, length, hashBackend);
+	if (theFlags & exactMembership) {
+		exactSlot_t entry;
+		entry.check = hashValue >> 32;
+		entry.ref = ref;
+		exactWordCount += 1;
+		if (!placeExact(exactWordTable, exactWordTableMask, &entry)) {
+			rebuildExact(entry); // no room for some word
+		} else if (oldExactWordTable) {
+			migrateExactBuckets(exactMigrationStep);
+		} else if (exactWordCount * 8 > (exactWordTableMask + 1) * 7) {
+			startExactMigration(2 * (exactWordTableMask + 1));
+		}
+		return;
+	}
+	setGoodBits(goodWordTable, goodWordTableMask, goodProbes, hashValue);
+	goodWordCount += 1;
+	if (newGoodWordTable) {
+		setGoodBits(newGoodWordTable, newGoodWordTableMask, newGoodProbes,
+			hashValue);
+		migrateGoodWords(goodMigrationStep);
+	} else if (goodWordCount > goodWordLimit) { // too many false positives
+		chooseGoodSize(2 * goodWordCount, &bits, &probes);
+		startGoodMigration(bits, probes);
+	}
+} // addGoodWord
+
+// Start building a replacement goodWordTable of bits bits, a power of 2, with
+// probes bits per word.  It is filled a few words at a time; until then, the
+// old one serves lookups.
+void uSpell::startGoodMigration(const int bits, const int probes) {
+	if (newGoodWordTable) migrateGoodWords(infinity); // finish the last one
+	newGoodWordTable = allocateGoodBits(bits);
+	newGoodWordTableMask = bits - 1;
+	newGoodProbes = probes;
+	goodMigratedIds = 1; // id 0 is not used
+	goodMigratedIgnored = 0;
+} // startGoodMigration
+
+// Put up to count more known words into the replacement goodWordTable; once
+// they are all there, it replaces the old one.
+void uSpell::migrateGoodWords(int count) {
+	utf8_t buffer[keyRoom+1];
+	const utf8_t *key;
+	int keyLength;
+	for (; count > 0 && goodMigratedIds < wordCount; count -= 1) {
+		key = goodKey(goodMigratedIds, buffer, &keyLength);
+		setGoodBits(newGoodWordTable, newGoodWordTableMask, newGoodProbes,
+			wordHash(key, keyLength, hashBackend));
+		goodMigratedIds += 1;
+	}
+	for (; count > 0 && goodMigratedIgnored < ignoredLength; count -= 1) {
+		key = goodKey(ignoredRef | goodMigratedIgnored, buffer, &keyLength);
+		setGoodBits(newGoodWordTable, newGoodWordTableMask, newGoodProbes,
+			wordHash(key, keyLength, hashBackend));
+		goodMigratedIgnored += keyLength + 2;
+	}
+	if (goodMigratedIds < wordCount || goodMigratedIgnored < ignoredLength)
+		return; // not done yet
+	if (goodWordTableOwned) free(goodWordTable);
+	goodWordTable = newGoodWordTable;
+	goodWordTableMask = newGoodWordTableMask;
+	goodWordTableLength = (goodWordTableMask + 1) >> 5;
+	goodProbes = newGoodProbes;
+	goodWordLimit = goodLimit(goodWordTableMask + 1, goodProbes);
+	goodWordTableOwned = true;
+	newGoodWordTable = NULL;
+} // migrateGoodWords
+
+bool uSpell::inGoodWordTable(const utf8_t *key, const int length) {
+	if (theFlags & exactMembership) return(findExact(key, length) != NULL);
+	return(testGoodBits(goodWordTable, goodWordTableMask, goodProbes,
+		wordHash(key, length, hashBackend)));
+} // inGoodWordTable
+
+bool uSpell::isSpelledRight(const wide_t *string, const int length) {
+	utf8_t key[keyRoom+1];
+	return(inGoodWordTable(key, wideKey(string, length, key)));
+} // isSpelledRight
+
+bool uSpell::isSpelledRight(const utf8_t *string, const size_t length) {
+	utf8_t buffer[keyRoom+1];
+	const utf8_t *key;
+	int keyLength = length;
+	key = utf8Key(string, &keyLength, buffer);
+	return(inGoodWordTable(key, keyLength));
+} // isSpelledRight
+
+double uSpell::falsePositiveRate() {
+	if (theFlags & exactMembership) return(0.0);
+	return(::falsePositiveRate(goodWordCount,
+		(goodWordTableMask + 1) / blockBits, goodProbes));
+} // falsePositiveRate
+
+// The key of the stored word ref, and its length in *length.  It may be built
+// in buffer, of keyRoom+1 bytes.
+const utf8_t *uSpell::goodKey(const __uint32_t ref, utf8_t *buffer,
+		int *length) {
+	const utf8_t *entry;
+	if (ref & ignoredRef) { // an ignored word, kept as its key
+		entry = ignoredWords + (ref & ~ignoredRef);
+		*length = entry[0] | (entry[1] << 8);
+		return(entry + 2);
+	}
+	*length = wordLengths[ref];
+	return(wordKey(wordAt(ref), length, buffer));
+} // goodKey
+
+static inline int otherBucket(const int bucket, const __uint32_t check,
+		const int bucketMask) {
+	return((bucket ^ (((check * 0x9e3779b1) >> 7) | 1)) & bucketMask);
+} // otherBucket
+
+// Find the slot of the key in the exactWordTable, or NULL.
+uSpell::exactSlot_t *uSpell::findExact(const utf8_t *key, const int length) {
+	__uint32_t check = wordHash(key, length, hashBackend) >> 32;
+	exactSlot_t *answer;
+	answer = findExactIn(exactWordTable, exactWordTableMask, 0, check, key,
+		length);
+	if (answer == NULL && oldExactWordTable) { // it may not have moved yet
+		answer = findExactIn(oldExactWordTable, oldExactWordTableMask,
+			exactMigratedBuckets, check, key, length);
+	}
+	return(answer);
+} // findExact
+
+// findExact() in one table, of mask+1 slots, skipping buckets below
+// migrated.
+uSpell::exactSlot_t *uSpell::findExactIn(exactSlot_t *table, const int mask,
+		const int migrated, const __uint32_t check, const utf8_t *key,
+		const int length) {
+	const int bucketMask = mask / exactBucketSlots;
+	int bucket, round, slot, storedLength;
+	utf8_t buffer[keyRoom+1];
+	const utf8_t *stored;
+	bucket = check & bucketMask;
+	for (round = 0; round < 2; round += 1) {
+		for (slot = bucket * exactBucketSlots;
+				bucket >= migrated && slot < (bucket+1) * exactBucketSlots;
+				slot += 1) {
+			if (table[slot].ref == 0 || table[slot].check != check) continue;
+			stored = goodKey(table[slot].ref, buffer, &storedLength);
+			if (storedLength == length && !memcmp(stored, key, length)) {
+				return(&table[slot]);
+			}
+		}
+		bucket = otherBucket(bucket, check, bucketMask);
+	}
+	return(NULL);
+} // findExactIn
+
+// Put *entry into table, of mask+1 slots, by cuckoo hashing: if both its
+// buckets are full, it evicts some entry, which moves to its other bucket,
+// and so on.  Returns false if that goes on too long, with *entry then
+// holding an entry that has no place.
+bool uSpell::placeExact(exactSlot_t *table, const int mask,
+		exactSlot_t *entry) {
+	const int bucketMask = mask / exactBucketSlots;
+	int bucket, slot, kick;
+	exactSlot_t carried;
+	bucket = entry->check & bucketMask;
+	for (kick = 0; kick <= maxKicks; kick += 1) {
+		for (slot = bucket * exactBucketSlots;
+				slot < (bucket+1) * exactBucketSlots; slot += 1) {
+			if (table[slot].ref == 0) {
+				table[slot] = *entry;
+				return(true);
+			}
+		}
+		if (kick == 0) { // try its other bucket before evicting anyone
+			bucket = otherBucket(bucket, entry->check, bucketMask);
+			continue;
+		}
+		kickSeed = kickSeed * 1103515245 + 12345;
+		slot = bucket * exactBucketSlots + (kickSeed >> 16) % exactBucketSlots;
+		carried = table[slot];
+		table[slot] = *entry;
+		*entry = carried;
+		bucket = otherBucket(bucket, entry->check, bucketMask);
+	}
+	return(false);
+} // placeExact
+
+// Make an empty exactWordTable of length slots, a power of 2.
+uSpell::exactSlot_t *uSpell::allocateExactWordTable(const int length) {
+	void *answer;
+	if (posix_memalign(&answer, exactBucketSlots * sizeof(exactSlot_t),
+			length * sizeof(exactSlot_t))) {
+		throw(noMem);
+	}
+	memset(answer, 0, length * sizeof(exactSlot_t));
+	return(reinterpret_cast<exactSlot_t *>(answer));
+} // allocateExactWordTable
+
+// Start moving the exactWordTable to a new one of length slots, a power of
+// 2, a few buckets for each word added.
+void uSpell::startExactMigration(const int length) {
+	if (oldExactWordTable) migrateExactBuckets(oldExactWordTableMask + 1);
+	if (length <= exactWordTableMask + 1) return; // it had to be rebuilt
+	oldExactWordTable = exactWordTable;
+	oldExactWordTableMask = exactWordTableMask;
+	oldExactWordTableOwned = exactWordTableOwned;
+	exactMigratedBuckets = 0;
+	exactWordTable = allocateExactWordTable(length);
+	exactWordTableMask = length - 1;
+	exactWordTableOwned = true;
+} // startExactMigration
+
+// Move the entries of up to count more buckets of the old table.
+void uSpell::migrateExactBuckets(int count) {
+	int slot;
+	exactSlot_t entry;
+	for (; count > 0 && oldExactWordTable; count -= 1) {
+		for (slot = exactMigratedBuckets * exactBucketSlots;
+				slot < (exactMigratedBuckets+1) * exactBucketSlots;
+				slot += 1) {
+			if (oldExactWordTable[slot].ref == 0) continue;
+			entry = oldExactWordTable[slot];
+			oldExactWordTable[slot].ref = 0; // so it is only in one table
+			if (!placeExact(exactWordTable, exactWordTableMask, &entry)) {
+				rebuildExact(entry);
+				return;
+			}
+		}
+		exactMigratedBuckets += 1;
+		if (exactMigratedBuckets * exactBucketSlots > oldExactWordTableMask) {
+			if (oldExactWordTableOwned) free(oldExactWordTable);
+			oldExactWordTable = NULL;
+		}
+	}
+} // migrateExactBuckets
+
+// Put everything in the exactWordTable, and in the old one if it is being
+// moved, together with homeless, into a new, larger exactWordTable, all at
+// once.  This is only needed if cuckoo hashing fails, which is rare.
+void uSpell::rebuildExact(exactSlot_t homeless) {
+	exactSlot_t *table, entry;
+	int length, slot;
+	bool placed;
+	for (length = 2 * (exactWordTableMask + 1); ; length *= 2) {
+		table = allocateExactWordTable(length);
+		entry = homeless;
+		placed = placeExact(table, length - 1, &entry);
+		for (slot = 0; placed && slot <= exactWordTableMask; slot += 1) {
+			if (exactWordTable[slot].ref == 0) continue;
+			entry = exactWordTable[slot];
+			placed = placeExact(table, length - 1, &entry);
+		}
+		for (slot = exactMigratedBuckets * exactBucketSlots;
+				placed && oldExactWordTable && slot <= oldExactWordTableMask;
+				slot += 1) {
+			if (oldExactWordTable[slot].ref == 0) continue;
+			entry = oldExactWordTable[slot];
+			placed = placeExact(table, length - 1, &entry);
+		}
+		if (placed) break;
+		free(table); // try a bigger one
+	}
+	if (exactWordTableOwned) free(exactWordTable);
+	if (oldExactWordTable && oldExactWordTableOwned) free(oldExactWordTable);
+	oldExactWordTable = NULL;
+	exactWordTable = table;
+	exactWordTableMask = length - 1;
+	exactWordTableOwned = true;
+} // rebuildExact
+
+bool uSpell::removeWord(const utf8_t *string) {
+	utf8_t buffer[keyRoom+1];
+	const utf8_t *key;
+	int length = strlen(reinterpret_cast<const char *>(string));
+	key = wordKey(string, &length, buffer); // as acceptWord() would have it
+	return(removeKey(key, length));
+} // removeWord
+
+bool uSpell::removeWord(const wide_t *string, const int length) {
+	utf8_t key[keyRoom+1];
+	int keyLength;
+	keyLength = wideWordKey(string, length, key); // as acceptWord() has it
+	return(removeKey(key, keyLength));
+} // removeWord
+
+bool uSpell::removeKey(const utf8_t *key, const int length) {
+	exactSlot_t *slot;
+	if (!(theFlags & exactMembership)) return(false); // Bloom filters can't
+	slot = findExact(key, length);
+	if (slot == NULL) return(false);
+	if (!(slot->ref & ignoredRef)) { // don't suggest it any more
+		wordOffsets[slot->ref] = removedWord;
+	}
+	slot->ref = 0;
+	exactWordCount -= 1;
+	return(true);
+} // removeKey
@@ -0,0 +1,173 @@
+// hashbench.cpp: compare the hash backends of the uspell package.
+// Usage: uhashbench wordfile transcribefile
+//
+//	wordfile is a dictionary file; each word terminated by \n.
+//	transcribefile is a file of "sounds like" for helping find
+//		close-sounding suggestions for misspelled words.  It may be "".
+//
+// Output, for each backend of wordhash.h: the time to hash the UTF-8 bytes of
+// every word of wordfile with wordHash(), as the goodWordTable does, and the
+// converted characters and their omissions with variantHashes(), as the
+// reducedWordTable does; the statistics of the
+// tables built with the backend, among them how many cache lines lookups in
+// the reducedWordTable read; and the false-positive rate of the
+// goodWordTable, measured on misspellings made by deleting or transposing
+// letters of every dictionary word, next to the rate expected.
+//
+// "make hashbench" runs it on the dictionaries in ../dic.
+//
+// license: Gnu Public License.
+
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "uspell.h"
+#include "utf8convert.h"
+#include "image.h"
+#include "wordhash.h"
+#include "rollhash.h"
+
+#define ROUNDS 5 // best of
+
+static volatile __uint64_t sink; // so the hashing isn't optimized away
+
+static double now() {
+	struct timespec theTime;
+	clock_gettime(CLOCK_MONOTONIC, &theTime);
+	return(theTime.tv_sec + theTime.tv_nsec / 1e9);
+} // now
+
+// Time both kinds of hashing over wordCount words: keys, keysLength bytes
+// holding each word as its length in bytes and then its UTF-8 form, and words,
+// wordsLength characters holding each as its length and then its characters.
+static void timeHashes(const utf8_t *keys, const size_t keysLength,
+		const wide_t *words, const size_t wordsLength, const int wordCount,
+		const int backend) {
+	__uint32_t hashes[BUFLEN];
+	__uint64_t sum = 0;
+	double start, best[2] = {1e9, 1e9};
+	size_t index;
+	int round, bytes, variant;
+	for (round = 0; round < ROUNDS; round += 1) {
+		start = now();
+		for (index = 0; index < keysLength; index += keys[index] + 1) {
+			sum += wordHash(keys + index + 1, keys[index], backend);
+		}
+		if (now() - start < best[0]) best[0] = now() - start;
+		start = now();
+		for (index = 0; index < wordsLength; index += words[index] + 1) {
+			sum += variantHashes(words + index + 1, words[index], backend,
+				hashes, NULL);
+			for (variant = 0; variant < static_cast<int>(words[index]);
+					variant += 1) {
+				sum += hashes[variant];
+			}
+		}
+		if (now() - start < best[1]) best[1] = now() - start;
+	}
+	bytes = keysLength - wordCount;
+	fprintf(stdout, "wordHash: %.1f ns/word, %.2f GB/s\n",
+		best[0] * 1e9 / wordCount, bytes / best[0] / 1e9);
+	fprintf(stdout, "variantHashes: %.1f ns/word\n",
+		best[1] * 1e9 / wordCount);
+	sink = sum;
+} // timeHashes
+
+// Count the misspellings of the words that speller accepts; truth is an
+// exact speller of the same words.
+static void measureFalsePositives(uSpell *speller, uSpell *truth,
+		const wide_t *words, const size_t wordsLength) {
+	wide_t probe[BUFLEN];
+	size_t index;
+	int length, position, tried = 0, accepted = 0;
+	for (index = 0; index < wordsLength; index += words[index] + 1) {
+		length = words[index];
+		for (position = 0; position < length; position += 1) {
+			// omit the letter at position
+			memcpy(probe, words + index + 1, position * sizeof(wide_t));
+			memcpy(probe + position, words + index + 2 + position,
+				(length - position - 1) * sizeof(wide_t));
+			if (length > 1 && !truth->isSpelledRight(probe, length - 1)) {
+				tried += 1;
+				if (speller->isSpelledRight(probe, length - 1)) accepted += 1;
+			}
+			// interchange it with the next letter
+			if (position + 1 == length) continue;
+			memcpy(probe, words + index + 1, length * sizeof(wide_t));
+			probe[position] = probe[position + 1];
+			probe[position + 1] = words[index + 1 + position];
+			if (!truth->isSpelledRight(probe, length)) {
+				tried += 1;
+				if (speller->isSpelledRight(probe, length)) accepted += 1;
+			}
+		}
+	}
+	fprintf(stdout, "false positives: %d of %d misspellings, rate %.6f; "
+		"expected %.6f\n", accepted, tried,
+		tried ? static_cast<double>(accepted) / tried : 0.0,
+		speller->falsePositiveRate());
+} // measureFalsePositives
+
+int main(int argc, char *argv[]) {
+	uSpell *speller, *truth;
+	utf8_t *text, *word, *next, *end;
+	size_t textLength, keysLength, wordsLength;
+	utf8_t *keys; // dictionary words as they are
+	wide_t *words; // converted dictionary words
+	int length, wordCount, backend;
+	double start;
+	static const char backendFlags[hashBackends] = {0, uSpell::multiplyHash};
+	if (argc != 3) {
+		fprintf(stdout, "Usage: %s wordfile transcribefile\n", argv[0]);
+		exit(1);
+	}
+	text = reinterpret_cast<utf8_t *>(mapFile(argv[1], &textLength));
+	if (text == NULL) {
+		perror(argv[1]);
+		exit(1);
+	}
+	end = text + textLength;
+	keys = reinterpret_cast<utf8_t *>(malloc(textLength + 1));
+	words = reinterpret_cast<wide_t *>(
+		malloc((textLength + 1) * sizeof(wide_t)));
+	if (keys == NULL || words == NULL) {
+		perror(argv[0]);
+		exit(1);
+	}
+	keysLength = wordsLength = wordCount = 0;
+	for (word = text; word < end; word = next + 1) {
+		next = reinterpret_cast<utf8_t *>(memchr(word, '\n', end - word));
+		if (next == NULL) next = end;
+		if (next == word || next - word >= BUFLEN) continue;
+		keys[keysLength] = next - word;
+		memcpy(keys + keysLength + 1, word, next - word);
+		keysLength += next - word + 1;
+		length = utf8_wide(words + wordsLength + 1, word, next - word, BUFLEN);
+		words[wordsLength] = length;
+		wordsLength += length + 1;
+		wordCount += 1;
+	}
+	unmapFile(text, textLength);
+	try {
+		truth = new uSpell(argv[1], argv[2], uSpell::exactMembership);
+	}
+	catch (...) {
+		fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[1]);
+		exit(1);
+	}
+	for (backend = 0; backend < hashBackends; backend += 1) {
+		fprintf(stdout, "backend %s:\n", backendNames[backend]);
+		timeHashes(keys, keysLength, words, wordsLength, wordCount,
+			backend);
+		start = now();
+		speller = new uSpell(argv[1], argv[2], backendFlags[backend]);
+		fprintf(stdout, "construct: %.3f s\n", now() - start);
+		measureFalsePositives(speller, truth, words, wordsLength);
+		speller->reportStatistics(stdout);
+		delete speller;
+	}
+	delete truth;
+	free(keys);
+	free(words);
+	return(0);
+} // main
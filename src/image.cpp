@@ -0,0 +1,360 @@
+// image.cpp
+// license: Gnu Public License.
+//
+// Precompiled dictionary images.  Assimilating a large dictionary costs
+// seconds; an image holds the finished tables and the main dictionary file,
+// so a new uSpell instance can map it and be ready at once.
+//
+// 	fileHash: identifies a transcription file
+// 	imageChecksum, headerChecksum, verifyImage: detect damaged images
+// 	readFile, mapFile, unmapFile: bring an image or dictionary file into
+// 		memory
+// 	uSpell::writeImage: writes an image
+// 	uSpell::uSpell(imageFile, transcriptionFile): initializes from an image
+
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "uspell.h"
+#include "transcribe.h"
+#include "uniprops.h"
+#include "image.h"
+#include "wordhash.h"
+
+#define roundUp(n) (((n) + imageAlign - 1) & ~(imageAlign - 1))
+
+ub4 fileHash(const char *fileName) {
+	ub1 *contents;
+	size_t length;
+	ub4 answer;
+	if (!*fileName) return(0);
+	contents = reinterpret_cast<ub1 *>(readFile(fileName, &length));
+	if (contents == NULL) return(0);
+	answer = hash(contents, length, 0);
+	free(contents);
+	return(answer);
+} // fileHash
+
+ub4 imageChecksum(const void *data, size_t length) {
+	return(hash2(reinterpret_cast<const ub4 *>(data), length/sizeof(ub4),
+		imageMagic));
+} // imageChecksum
+
+// The checksum of the header, which covers the section table but not the
+// sections, and not the checksum itself.
+static ub4 headerChecksum(const imageHeader_t *header) {
+	imageHeader_t copy = *header;
+	copy.checksum = 0;
+	return(imageChecksum(&copy, sizeof(copy)));
+} // headerChecksum
+
+bool verifyImage(const char *imageFile) {
+	const imageHeader_t *header;
+	size_t length;
+	bool answer;
+	void *image = mapFile(imageFile, &length);
+	if (image == NULL) return(false);
+	header = reinterpret_cast<const imageHeader_t *>(image);
+	answer = length >= roundUp(sizeof(imageHeader_t)) &&
+		header->magic == imageMagic && header->version == imageVersion &&
+		header->checksum == headerChecksum(header) &&
+		header->payloadChecksum == imageChecksum(
+			reinterpret_cast<ub1 *>(image) + roundUp(sizeof(imageHeader_t)),
+			(length - roundUp(sizeof(imageHeader_t))) & ~3);
+	unmapFile(image, length);
+	return(answer);
+} // verifyImage
+
+void *readFile(const char *fileName, size_t *length) {
+	FILE *theFile;
+	void *answer;
+	long fileLength;
+	theFile = fopen(fileName, "r");
+	if (theFile == NULL) return(NULL);
+	fseek(theFile, 0L, SEEK_END);
+	fileLength = ftell(theFile);
+	fseek(theFile, 0L, SEEK_SET);
+	answer = fileLength < 0 ? NULL : malloc(fileLength + 1);
+	if (answer == NULL || fread(answer, 1, fileLength, theFile) !=
+			static_cast<size_t>(fileLength)) {
+		free(answer);
+		fclose(theFile);
+		return(NULL);
+	}
+	fclose(theFile);
+	*length = fileLength;
+	return(answer);
+} // readFile
+
+static char emptyFile[1]; // what an empty file maps to
+
+void *mapFile(const char *fileName, size_t *length) {
+	int fd;
+	struct stat status;
+	void *answer;
+	fd = open(fileName, O_RDONLY);
+	if (fd < 0) return(NULL);
+	if (fstat(fd, &status)) {
+		close(fd);
+		return(NULL);
+	}
+	if (status.st_size == 0) { // mmap refuses these
+		close(fd);
+		*length = 0;
+		return(emptyFile);
+	}
+	// Private and writable: acceptWord() may modify the tables, and those
+	// pages are then copied; the file itself is never changed.
+	answer = mmap(NULL, status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+		fd, 0);
+	close(fd);
+	if (answer == MAP_FAILED) return(NULL);
+	*length = status.st_size;
+	return(answer);
+} // mapFile
+
+void unmapFile(void *contents, size_t length) {
+	if (length) munmap(contents, length);
+} // unmapFile
+
+bool uSpell::writeImage(const char *imageFile) {
+	imageHeader_t *header;
+	ub1 *buffer;
+	size_t offset, written;
+	int section;
+	FILE *outFile;
+	const void *contents[imageSectionCount]; // what goes in each section
+	imageSection_t sections[imageSectionCount];
+	if (fileNumber != 1 || wordFiles[NUMDICTFILES].text != NULL ||
+			ignoredLength)
+		return(false); // only the main dictionary may be in the tables
+	settleTables();
+	contents[goodWordSection] = goodWordTable;
+	sections[goodWordSection].length = goodWordTable ?
+		goodWordTableLength * sizeof(goodWordTable[0]) : 0;
+	contents[exactWordSection] = exactWordTable;
+	sections[exactWordSection].length = exactWordTable ?
+		(exactWordTableMask + 1) * sizeof(exactWordTable[0]) : 0;
+	contents[reducedWordSection] = reducedWordTable;
+	sections[reducedWordSection].length =
+		reducedWordTableLength * sizeof(reducedWordTable[0]);
+	contents[wordBlobSection] = wordFiles[1].text;
+	sections[wordBlobSection].length = wordFiles[1].length;
+	contents[wordOffsetSection] = wordOffsets;
+	sections[wordOffsetSection].length = wordCount * sizeof(wordOffsets[0]);
+	contents[wordLengthSection] = wordLengths;
+	sections[wordLengthSection].length = wordCount * sizeof(wordLengths[0]);
+	contents[reducedStartSection] = reducedStarts;
+	sections[reducedStartSection].length =
+		wordCount * sizeof(reducedStarts[0]);
+	contents[reducedLengthSection] = reducedLengths;
+	sections[reducedLengthSection].length =
+		wordCount * sizeof(reducedLengths[0]);
+	contents[signatureSection] = signatures;
+	sections[signatureSection].length = wordCount * sizeof(signatures[0]);
+	contents[reducedBlobSection] = reducedBlob;
+	sections[reducedBlobSection].length =
+		reducedBlobLength * sizeof(reducedBlob[0]);
+	contents[alphabetSection] = alphabet;
+	sections[alphabetSection].length = alphabetSize * sizeof(alphabet[0]);
+	// lay out the sections
+	offset = roundUp(sizeof(imageHeader_t));
+	for (section = 0; section < imageSectionCount; section += 1) {
+		sections[section].offset = offset;
+		offset = roundUp(offset + sections[section].length);
+	}
+	// fill in the image
+	buffer = reinterpret_cast<ub1 *>(calloc(offset, 1));
+	if (buffer == NULL) return(false);
+	for (section = 0; section < imageSectionCount; section += 1) {
+		if (sections[section].length == 0) continue;
+		memcpy(buffer + sections[section].offset, contents[section],
+			sections[section].length);
+	}
+	header = reinterpret_cast<imageHeader_t *>(buffer);
+	header->magic = imageMagic;
+	header->version = imageVersion;
+	header->flags = theFlags;
+	header->transcriptionHash = transcriptionHash;
+	header->reducedWordTableMask = reducedWordTableMask;
+	header->reducedWordCount = reducedWordCount;
+	header->goodWordTableMask = goodWordTableMask;
+	header->goodWordCount = goodWordCount;
+	header->goodProbes = goodProbes;
+	header->exactWordTableMask = exactWordTableMask;
+	header->exactWordCount = exactWordCount;
+	header->wordCount = wordCount;
+	header->sectionCount = imageSectionCount;
+	memcpy(header->sections, sections, sizeof(sections));
+	header->payloadChecksum = imageChecksum(
+		buffer + roundUp(sizeof(imageHeader_t)),
+		offset - roundUp(sizeof(imageHeader_t)));
+	header->checksum = headerChecksum(header);
+	// write it out
+	outFile = fopen(imageFile, "w");
+	if (outFile == NULL) {
+		free(buffer);
+		return(false);
+	}
+	written = fwrite(buffer, 1, offset, outFile);
+	free(buffer);
+	if (fclose(outFile) || written != offset) return(false);
+	return(true);
+} // writeImage
+
+uSpell::uSpell(const char *imageFile, const char *transcriptionFile) {
+	const imageHeader_t *header;
+	ub1 *base;
+	const wide_t *characters; // of the alphabet
+	int section, code, codeCount;
+	image = mapFile(imageFile, &imageLength);
+	if (image == NULL) {
+		throw(noSuchFile);
+	}
+	base = reinterpret_cast<ub1 *>(image);
+	header = reinterpret_cast<const imageHeader_t *>(image);
+	// check that the image is one we can use.  Only the header is checked
+	// against its checksum; reading the whole image would bring in every
+	// page of it.
+	if (imageLength < roundUp(sizeof(imageHeader_t)) ||
+			header->magic != imageMagic ||
+			header->version != imageVersion ||
+			header->checksum != headerChecksum(header) ||
+			header->sectionCount != imageSectionCount) {
+		unmapFile(image, imageLength);
+		throw(badImage);
+	}
+	for (section = 0; section < imageSectionCount; section += 1) {
+		if (header->sections[section].offset > imageLength ||
+				header->sections[section].length >
+				imageLength - header->sections[section].offset) {
+			unmapFile(image, imageLength);
+			throw(badImage);
+		}
+	}
+	if (header->sections[reducedWordSection].length !=
+			(header->reducedWordTableMask + 1) * sizeof(slot_t) ||
+			(header->reducedWordTableMask + 1) % bucketSlots ||
+			header->reducedWordCount > header->reducedWordTableMask ||
+			(header->flags & exactMembership ?
+				header->sections[exactWordSection].length !=
+				(header->exactWordTableMask + 1) * sizeof(exactSlot_t) ||
+				(header->exactWordTableMask + 1) % exactBucketSlots ||
+				header->exactWordCount > header->exactWordTableMask
+			:
+				header->sections[goodWordSection].length !=
+				((header->goodWordTableMask + 1) >> 5) * sizeof(fileOffset_t) ||
+				(header->goodWordTableMask + 1) % 512 ||
+				header->goodProbes < 1 ||
+				header->goodProbes > maxGoodProbes) ||
+			header->wordCount == 0 ||
+			header->sections[wordOffsetSection].length !=
+			header->wordCount * sizeof(wordOffsets[0]) ||
+			header->sections[wordLengthSection].length !=
+			header->wordCount * sizeof(wordLengths[0]) ||
+			header->sections[reducedStartSection].length !=
+			header->wordCount * sizeof(reducedStarts[0]) ||
+			header->sections[reducedLengthSection].length !=
+			header->wordCount * sizeof(reducedLengths[0]) ||
+			header->sections[signatureSection].length !=
+			header->wordCount * sizeof(signatures[0]) ||
+			header->sections[alphabetSection].length <
+			sizeof(alphabet[0]) ||
+			header->sections[alphabetSection].length >
+			escapeCode * sizeof(alphabet[0]) ||
+			header->sections[alphabetSection].length % sizeof(alphabet[0])) {
+		unmapFile(image, imageLength);
+		throw(badImage);
+	}
+	transcriptionHash = fileHash(transcriptionFile);
+	if (header->transcriptionHash != transcriptionHash) {
+		unmapFile(image, imageLength);
+		throw(badImage);
+	}
+	theFlags = header->flags;
+	hashBackend = theFlags & multiplyHash ? multiplyBackend : lookup2Backend;
+	myTranscribe = new transcriber(transcriptionFile);
+	reduceWord = reducerFor(theFlags & expandPrecomposed,
+		myTranscribe->hasRules());
+	reduceProbe = reducerFor(false, myTranscribe->hasRules());
+	// the tables live in the image
+	reducedWordTable = reinterpret_cast<slot_t *>(base +
+		header->sections[reducedWordSection].offset);
+	reducedWordTableMask = header->reducedWordTableMask;
+	reducedWordTableLength = reducedWordTableMask + 1;
+	reducedWordCount = header->reducedWordCount;
+	reducedWordTableOwned = false; // copied out before it is modified
+	goodWordTable = NULL;
+	if (!(theFlags & exactMembership)) {
+		goodWordTable = reinterpret_cast<hashTable>(base +
+			header->sections[goodWordSection].offset);
+	}
+	goodWordTableMask = header->goodWordTableMask;
+	goodWordTableLength = (goodWordTableMask + 1) >> 5;
+	goodWordCount = header->goodWordCount;
+	goodProbes = header->goodProbes;
+	goodWordLimit = goodLimit(goodWordTableMask + 1, goodProbes);
+	goodWordTableOwned = false;
+	exactWordTable = NULL;
+	if (theFlags & exactMembership) {
+		exactWordTable = reinterpret_cast<exactSlot_t *>(base +
+			header->sections[exactWordSection].offset);
+	}
+	exactWordTableMask = header->exactWordTableMask;
+	exactWordCount = header->exactWordCount;
+	exactWordTableOwned = false;
+	kickSeed = 1;
+	// none of them is growing yet
+	oldReducedWordTable = NULL;
+	newGoodWordTable = NULL;
+	oldExactWordTable = NULL;
+	ignoredWords = NULL;
+	ignoredLength = ignoredRoom = 0;
+	// so do the word columns
+	wordCount = header->wordCount;
+	wordRoom = 0; // we don't own them
+	wordOffsets = reinterpret_cast<fileOffset_t *>(base +
+		header->sections[wordOffsetSection].offset);
+	wordLengths = reinterpret_cast<__uint16_t *>(base +
+		header->sections[wordLengthSection].offset);
+	reducedStarts = reinterpret_cast<__uint32_t *>(base +
+		header->sections[reducedStartSection].offset);
+	reducedLengths = base + header->sections[reducedLengthSection].offset;
+	signatures = reinterpret_cast<__uint64_t *>(base +
+		header->sections[signatureSection].offset);
+	reducedBlob = base + header->sections[reducedBlobSection].offset;
+	reducedBlobLength = header->sections[reducedBlobSection].length /
+		sizeof(reducedBlob[0]);
+	reducedBlobRoom = 0; // we don't own it
+	// the alphabet is rebuilt in the order the image has it
+	characters = reinterpret_cast<const wide_t *>(base +
+		header->sections[alphabetSection].offset);
+	codeCount = header->sections[alphabetSection].length / sizeof(alphabet[0]);
+	initAlphabet();
+	for (code = 1; code < codeCount; code += 1) {
+		addToAlphabet(characters[code]);
+	}
+	scoredCandidates = boundedCandidates = 0;
+	trieNodes = NULL;
+	trieNodeCount = trieNodeRoom = 0;
+	trieNextWords = NULL;
+	trieNextRoom = 0;
+	trieDistance = 0;
+	editRanking = false;
+	trieLookups = trieVisits = 0;
+	deletionBuckets = NULL;
+	deletionChecks = NULL;
+	deletionIds = NULL;
+	deletionCount = 0;
+	deletionIndexed = 0;
+	deletionLength = -1;
+	deletionLimit = twoDeletionBytes;
+	// the main dictionary file also lives in the image
+	memset(wordFiles, 0, (NUMDICTFILES+1) * sizeof(wordFiles[0]));
+	wordFiles[1].text = base + header->sections[wordBlobSection].offset;
+	wordFiles[1].length = header->sections[wordBlobSection].length;
+	fileNumber = 1; // assimilateFile will continue with file #2.
+} // uSpell::uSpell
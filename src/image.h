@@ -0,0 +1,80 @@
+// image.h
+// license: Gnu Public License.
+//
+// Layout of a precompiled dictionary image, as written by
+// uSpell::writeImage() and mapped by the image initializer of uSpell.
+//
+// An image is one file: a fixed header, then a number of sections, each
+// starting on an imageAlign boundary.  All numbers are in the byte order of
+// the machine that wrote the image; a reader on another kind of machine sees a
+// bad magic number and refuses the image.
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stddef.h>
+#include "lookup2.h"
+
+static const ub4 imageMagic = 0x49705375; // "uSpI" when little-endian
+static const ub4 imageVersion = 13; // increment when the layout changes
+static const int imageAlign = 64; // sections start on cache lines
+
+// section numbers
+enum {
+	goodWordSection = 0, // goodWordTable bit array
+	exactWordSection, // exactWordTable slots, with exactMembership
+	reducedWordSection, // reducedWordTable slots
+	wordBlobSection, // the main dictionary file, byte for byte
+	wordOffsetSection, // the word columns, indexed by word id
+	wordLengthSection,
+	reducedStartSection,
+	reducedLengthSection,
+	signatureSection,
+	reducedBlobSection, // the reduced forms that reducedStartSection indexes
+	alphabetSection, // the character of each alphabet code, from code 0
+	imageSectionCount // must be last
+};
+
+typedef struct {
+	ub4 offset; // from the start of the image, in bytes
+	ub4 length; // in bytes
+} imageSection_t;
+
+typedef struct {
+	ub4 magic; // imageMagic
+	ub4 version; // imageVersion
+	ub4 flags; // the flags given to the initializer that built the tables
+	ub4 transcriptionHash; // fileHash() of the transcription file
+	ub4 reducedWordTableMask; // in slots
+	ub4 reducedWordCount; // slots in use
+	ub4 goodWordTableMask; // in bits
+	ub4 goodWordCount; // words added to the goodWordTable
+	ub4 goodProbes; // bits per word in it
+	ub4 exactWordTableMask; // in slots, with exactMembership
+	ub4 exactWordCount;
+	ub4 wordCount; // word ids in use, counting the unused 0
+	ub4 checksum; // imageChecksum() of the header, with this field 0
+	ub4 payloadChecksum; // imageChecksum() of everything after the header;
+		// only verifyImage() reads it all to check
+	ub4 sectionCount; // imageSectionCount
+	imageSection_t sections[imageSectionCount];
+} imageHeader_t;
+
+ub4 fileHash(const char *fileName);
+	// hash of the contents of the file, or 0 if there is no such file.  An
+	// empty fileName also gives 0.
+ub4 imageChecksum(const void *data, size_t length);
+	// length must be a multiple of 4.
+bool verifyImage(const char *imageFile);
+	// whether the image is intact, sections and all.  The image
+	// initializer checks only the header, so that it needn't read the
+	// whole image.
+void *readFile(const char *fileName, size_t *length);
+	// reads the file into newly allocated memory, at least one byte, that
+	// the caller should free(); returns NULL on failure.
+void *mapFile(const char *fileName, size_t *length);
+	// maps the file (an image or a dictionary file) copy-on-write; returns
+	// NULL on failure.  The caller should unmapFile() it when done.
+void unmapFile(void *contents, size_t length);
+
+#endif // IMAGE_H
@@ -1,16 +1,15 @@
 /*
 --------------------------------------------------------------------
 lookup2.c, by Bob Jenkins, December 1996, Public Domain.
-hash(), hash2(), hash3, and mix() are externally useful functions.
-Routines to test the hash are included if SELF_TEST is defined.
+hash(), hash2(), hashlong(), hash3, and mix() are externally useful functions.
 You can use this free for any purpose.  It has no warranty.
 --------------------------------------------------------------------
 */
-// #define SELF_TEST
 
 #include <stdio.h>
 #include <stddef.h>
 #include <stdlib.h>
+typedef  __uint64_t  ub8;   /* unsigned 8-byte quantities */
 typedef  __uint32_t  ub4;   /* unsigned 4-byte quantities */
 typedef  unsigned       char ub1;
 
@@ -186,6 +185,65 @@ ub4 hash2(register const ub4 *k, register ub4 length, register ub4 initval)
    return c;
 }
 
+/*
+--------------------------------------------------------------------
+ hashlong() is hash(), but it returns 64 bits: b in the high half and
+ c (what hash() returns) in the low half.  b is mixed as well as c, so
+ a caller that needs several hash values can take them all from one call.
+--------------------------------------------------------------------
+*/
+ub8 hashlong(register const ub1 *k, register ub4 length, register ub4 initval)
+{
+   register ub4 a,b,c,len;
+
+   /* Set up the internal state */
+   len = length;
+   a = b = 0x9e3779b9;  /* the golden ratio; an arbitrary value */
+   c = initval;           /* the previous hash value */
+
+   /*---------------------------------------- handle most of the key */
+   while (len >= 12)
+   {
+      a += (k[0] +((ub4)k[1]<<8) +((ub4)k[2]<<16) +((ub4)k[3]<<24));
+      b += (k[4] +((ub4)k[5]<<8) +((ub4)k[6]<<16) +((ub4)k[7]<<24));
+      c += (k[8] +((ub4)k[9]<<8) +((ub4)k[10]<<16)+((ub4)k[11]<<24));
+      mix(a,b,c);
+      k += 12; len -= 12;
+   }
+
+   /*------------------------------------- handle the last 11 bytes */
+   c += length;
+   switch(len)              /* all the case statements fall through */
+   {
+   case 11: c+=((ub4)k[10]<<24);
+      /* fall through */
+   case 10: c+=((ub4)k[9]<<16);
+      /* fall through */
+   case 9 : c+=((ub4)k[8]<<8);
+      /* the first byte of c is reserved for the length */
+      /* fall through */
+   case 8 : b+=((ub4)k[7]<<24);
+      /* fall through */
+   case 7 : b+=((ub4)k[6]<<16);
+      /* fall through */
+   case 6 : b+=((ub4)k[5]<<8);
+      /* fall through */
+   case 5 : b+=k[4];
+      /* fall through */
+   case 4 : a+=((ub4)k[3]<<24);
+      /* fall through */
+   case 3 : a+=((ub4)k[2]<<16);
+      /* fall through */
+   case 2 : a+=((ub4)k[1]<<8);
+      /* fall through */
+   case 1 : a+=k[0];
+     /* case 0: nothing left to add */
+   }
+   mix(a,b,c);
+   /*-------------------------------------------- report the result */
+   return (static_cast<ub8>(b) << 32) | c;
+}
+
 /*
 --------------------------------------------------------------------
  This is identical to hash() on little-endian machines (like Intel 
@@ -252,158 +310,3 @@ ub4 hash3(ub1 *k, ub4 length, ub4 initval)
    return c;
 }
 #endif
-
-
-#ifdef SELF_TEST
-
-/* used for timings */
-void driver1()
-{
-  ub4 buf[256];
-  ub4 i;
-  ub4 h=0;
-
-  for (i=0; i<256; ++i) 
-  {
-    h = hash(buf,i,h);
-  }
-}
-
-/* check that every input bit changes every output bit half the time */
-#define HASHSTATE 1
-#define HASHLEN   1
-#define MAXPAIR 80
-#define MAXLEN 70
-void driver2()
-{
-  ub1 qa[MAXLEN+1], qb[MAXLEN+2], *a = &qa[0], *b = &qb[1];
-  ub4 c[HASHSTATE], d[HASHSTATE], i, j=0, k, l, m, z;
-  ub4 e[HASHSTATE],f[HASHSTATE],g[HASHSTATE],h[HASHSTATE];
-  ub4 x[HASHSTATE],y[HASHSTATE];
-  ub4 hlen;
-
-  printf("No more than %d trials should ever be needed \n",MAXPAIR/2);
-  for (hlen=0; hlen < MAXLEN; ++hlen)
-  {
-    z=0;
-    for (i=0; i<hlen; ++i)  /*----------------------- for each input byte, */
-    {
-      for (j=0; j<8; ++j)   /*------------------------ for each input bit, */
-      {
-	for (m=1; m<8; ++m) /*------------ for serveral possible initvals, */
-	{
-	  for (l=0; l<HASHSTATE; ++l) e[l]=f[l]=g[l]=h[l]=x[l]=y[l]=~((ub4)0);
-
-      	  /*---- check that every output bit is affected by that input bit */
-	  for (k=0; k<MAXPAIR; k+=2)
-	  { 
-	    ub4 finished=1;
-	    /* keys have one bit different */
-	    for (l=0; l<hlen+1; ++l) {a[l] = b[l] = (ub1)0;}
-	    /* have a and b be two keys differing in only one bit */
-	    a[i] ^= (k<<j);
-	    a[i] ^= (k>>(8-j));
-	     c[0] = hash(a, hlen, m);
-	    b[i] ^= ((k+1)<<j);
-	    b[i] ^= ((k+1)>>(8-j));
-	     d[0] = hash(b, hlen, m);
-	    /* check every bit is 1, 0, set, and not set at least once */
-	    for (l=0; l<HASHSTATE; ++l)
-	    {
-	      e[l] &= (c[l]^d[l]);
-	      f[l] &= ~(c[l]^d[l]);
-	      g[l] &= c[l];
-	      h[l] &= ~c[l];
-	      x[l] &= d[l];
-	      y[l] &= ~d[l];
-	      if (e[l]|f[l]|g[l]|h[l]|x[l]|y[l]) finished=0;
-	    }
-	    if (finished) break;
-	  }
-	  if (k>z) z=k;
-	  if (k==MAXPAIR) 
-	  {
-	     printf("Some bit didn't change: ");
-	     printf("%.8lx %.8lx %.8lx %.8lx %.8lx %.8lx  ",
-	            e[0],f[0],g[0],h[0],x[0],y[0]);
-	     printf("i %ld j %ld m %ld len %ld\n",i,j,m,hlen);
-	  }
-	  if (z==MAXPAIR) goto done;
-	}
-      }
-    }
-   done:
-    if (z < MAXPAIR)
-    {
-      printf("Mix success  %2ld bytes  %2ld initvals  ",i,m);
-      printf("required  %ld  trials\n",z/2);
-    }
-  }
-  printf("\n");
-}
-
-/* Check for reading beyond the end of the buffer and alignment problems */
-void driver3()
-{
-  ub1 buf[MAXLEN+20], *b;
-  ub4 len;
-  ub1 q[] = "This is the time for all good men to come to the aid of their country";
-  ub1 qq[] = "xThis is the time for all good men to come to the aid of their country";
-  ub1 qqq[] = "xxThis is the time for all good men to come to the aid of their country";
-  ub1 qqqq[] = "xxxThis is the time for all good men to come to the aid of their country";
-  ub4 h,i,j,ref,x,y;
-
-  printf("Endianness.  These should all be the same:\n");
-  printf("%.8lx\n", hash(q, sizeof(q)-1, (ub4)0));
-  printf("%.8lx\n", hash(qq+1, sizeof(q)-1, (ub4)0));
-  printf("%.8lx\n", hash(qqq+2, sizeof(q)-1, (ub4)0));
-  printf("%.8lx\n", hash(qqqq+3, sizeof(q)-1, (ub4)0));
-  printf("\n");
-  for (h=0, b=buf+1; h<8; ++h, ++b)
-  {
-    for (i=0; i<MAXLEN; ++i)
-    {
-      len = i;
-      for (j=0; j<i; ++j) *(b+j)=0;
-
-      /* these should all be equal */
-      ref = hash(b, len, (ub4)1);
-      *(b+i)=(ub1)~0;
-      *(b-1)=(ub1)~0;
-      x = hash(b, len, (ub4)1);
-      y = hash(b, len, (ub4)1);
-      if ((ref != x) || (ref != y)) 
-      {
-	printf("alignment error: %.8lx %.8lx %.8lx %ld %ld\n",ref,x,y,h,i);
-      }
-    }
-  }
-}
-
-/* check for problems with nulls */
- void driver4()
-{
-  ub1 buf[1];
-  ub4 h,i,state[HASHSTATE];
-
-
-  buf[0] = ~0;
-  for (i=0; i<HASHSTATE; ++i) state[i] = 1;
-  printf("These should all be different\n");
-  for (i=0, h=0; i<8; ++i)
-  {
-    h = hash(buf, (ub4)0, h);
-    printf("%2ld  0-byte strings, hash is  %.8lx\n", i, h);
-  }
-}
-
-int main()
-{
-  driver1();   /* test that the key is hashed: used for timings */
-  driver2();   /* test that whole key is hashed thoroughly */
-  driver3();   /* test that nothing but the key is hashed */
-  driver4();   /* test hashing multiple buffers (all buffers are null) */
-  return 1;
-}
-
-#endif  /* SELF_TEST */
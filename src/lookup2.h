@@ -3,10 +3,12 @@
 #ifndef LOOKUP2_H
 #define LOOKUP2_H
 
+typedef  __uint64_t  ub8;   /* unsigned 8-byte quantities */
 typedef  __uint32_t  ub4;   /* unsigned 4-byte quantities */
 typedef  unsigned       char ub1;
 
 ub4 hash(register ub1 *k, register ub4 length, register ub4 initval);
 ub4 hash2(register const ub4 *k, register ub4 length, register ub4 initval);
+ub8 hashlong(register const ub1 *k, register ub4 length, register ub4 initval);
 
 #endif
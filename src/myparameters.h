@@ -10,5 +10,11 @@
 #	define BUFLEN 100 // long enough for any reasonable word in utf8
 #	define UCSLEVEL 4 // either 2 or 4; 2 is not currently supported, because
 		// the hash routines work faster with UCS4. 
+#	if defined(__SSE2__) && UCSLEVEL == 4
+#		define WIDE_SSE2 // SSE2 handles runs of ASCII, four wide_t at a time
+#	endif
+#	ifdef __SSE2__
+#		define CODES_SSE2 // SSE2 compares alphabet codes sixteen at a time
+#	endif
 
 #endif
@@ -0,0 +1,113 @@
+// rollhash.cpp
+// license: Gnu Public License.
+//
+// A string s of length n is first hashed as the polynomial
+// 	P(s) = s[0]*B^(n-1) + s[1]*B^(n-2) + ... + s[n-1]
+// modulo 2^64, for an odd B, and P(s) and n are then mixed into 32 bits by
+// the chosen backend.
+// Since P is linear, the polynomial of s with s[i] omitted is
+// 	P(s[0..i)) * B^(n-1-i) + P(s(i..n)),
+// and that of s with s[i-1] and s[i] interchanged is
+// 	P(s) + (s[i] - s[i-1]) * B^(n-1-i) * (B-1),
+// so one pass over the prefixes and one over the suffixes give all of them,
+// and the hash of s itself, at once.  Likewise, with s[i] and s[j] omitted
+// (i < j), it is
+// 	P(s[0..i)) * B^(n-2-i) + P(s(i..j)) * B^(n-1-j) + P(s(j..n)),
+// where P(s[a..b)) = P(s[0..b)) - P(s[0..a)) * B^(b-a), so each of those
+// costs a few multiplications once the prefixes and powers of B are known.
+// Equal strings get equal hashes however they are computed, which is all
+// the reducedWordTable needs.  Distinct strings as short as words collide in
+// P only by chance.
+//
+// 	finish: mix a polynomial and a length into the hash
+// 	rollHash: the hash of one string
+// 	variantHashes: the hashes of a string and its variants, in one pass
+// 	omissionPairHashes: the hashes of a string with two characters omitted
+
+#include "myparameters.h"
+#include "rollhash.h"
+#include "wordhash.h"
+
+static const __uint64_t base = 0x1d6b5f3a97c2e483ULL; // odd
+
+// Every bit of the polynomial must affect the low bits, which choose the
+// bucket.  The lookup2Backend uses the finalizer of MurmurHash3.
+static inline __uint32_t finish(const __uint64_t polynomial,
+		const int length, const int backend) {
+	__uint64_t answer = polynomial + length * 0x9e3779b97f4a7c15ULL;
+	if (backend == multiplyBackend) {
+		return(static_cast<__uint32_t>(
+			multiplyFold(answer, 0xe7037ed1a0b428dbULL)));
+	}
+	answer ^= answer >> 33;
+	answer *= 0xff51afd7ed558ccdULL;
+	answer ^= answer >> 33;
+	answer *= 0xc4ceb9fe1a85ec53ULL;
+	answer ^= answer >> 33;
+	return(static_cast<__uint32_t>(answer));
+} // finish
+
+__uint32_t rollHash(const wide_t *string, const int length,
+		const int backend) {
+	__uint64_t polynomial = 0;
+	int index;
+	for (index = 0; index < length; index += 1) {
+		polynomial = polynomial * base + string[index];
+	}
+	return(finish(polynomial, length, backend));
+} // rollHash
+
+__uint32_t variantHashes(const wide_t *string, const int length,
+		const int backend, __uint32_t *omissions, __uint32_t *interchanges) {
+	__uint64_t prefixes[BUFLEN+1]; // prefixes[i] = P(string[0..i))
+	__uint64_t suffix, power; // P(string(i..length)), B^(length-1-i)
+	__uint64_t polynomial; // P(string)
+	int index;
+	prefixes[0] = 0;
+	for (index = 0; index < length; index += 1) {
+		prefixes[index+1] = prefixes[index] * base + string[index];
+	}
+	polynomial = prefixes[length];
+	suffix = 0;
+	power = 1;
+	for (index = length - 1; index >= 0; index -= 1) {
+		omissions[index] = finish(prefixes[index] * power + suffix,
+			length - 1, backend);
+		if (interchanges && index >= 1) { // power * (B-1) is the multiplier
+			interchanges[index-1] = finish(polynomial +
+				(static_cast<__uint64_t>(string[index]) - string[index-1]) *
+				(power * (base - 1)), length, backend);
+		}
+		suffix += string[index] * power;
+		power *= base;
+	}
+	return(finish(polynomial, length, backend));
+} // variantHashes
+
+int omissionPairHashes(const wide_t *string, const int length,
+		const int backend, __uint32_t *omissions) {
+	__uint64_t prefixes[BUFLEN+1]; // prefixes[i] = P(string[0..i))
+	__uint64_t powers[BUFLEN+1]; // powers[i] = B^i
+	__uint64_t before, between; // P(string[0..i)) * B^(length-2-i),
+		// P(string(i..j))
+	int first, second, count;
+	prefixes[0] = 0;
+	powers[0] = 1;
+	for (first = 0; first < length; first += 1) {
+		prefixes[first+1] = prefixes[first] * base + string[first];
+		powers[first+1] = powers[first] * base;
+	}
+	count = 0;
+	for (first = 0; first < length - 1; first += 1) {
+		before = prefixes[first] * powers[length-2-first];
+		for (second = first + 1; second < length; second += 1) {
+			between = prefixes[second] -
+				prefixes[first+1] * powers[second-first-1];
+			omissions[count++] = finish(before +
+				between * powers[length-1-second] + prefixes[length] -
+				prefixes[second+1] * powers[length-1-second], length - 2,
+				backend);
+		}
+	}
+	return(count);
+} // omissionPairHashes
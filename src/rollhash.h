@@ -0,0 +1,29 @@
+// rollhash.h
+// license: Gnu Public License.
+//
+// Hashing of reduced forms for the reducedWordTable.  A word, all its
+// one-character omissions and all its adjacent interchanges are hashed
+// together in time proportional to the length of the word; all its
+// two-character omissions, in time proportional to their number.  The
+// polynomial hash is finished by one of the backends of wordhash.h.
+
+#ifndef ROLLHASH_H
+#define ROLLHASH_H
+
+#include "mytypes.h"
+
+__uint32_t rollHash(const wide_t *string, const int length,
+	const int backend);
+__uint32_t variantHashes(const wide_t *string, const int length,
+	const int backend, __uint32_t *omissions, __uint32_t *interchanges);
+	// returns rollHash() of string, and sets omissions[i] = rollHash() of
+	// string without string[i], for each i; and unless interchanges is NULL,
+	// interchanges[i-1] = rollHash() of string with string[i-1] and
+	// string[i] interchanged, for i from 1 to length-1.
+int omissionPairHashes(const wide_t *string, const int length,
+	const int backend, __uint32_t *omissions);
+	// sets omissions[] to rollHash() of string without string[i] and
+	// string[j], for each i < j, by i and then by j; returns how many there
+	// are, length*(length-1)/2.
+
+#endif // ROLLHASH_H
@@ -13,19 +13,58 @@
 #include <string.h>
 #include <stdlib.h>
 #include "utf8convert.h"
+#include "lookup2.h"
+#include "uspell.h"
 #include "transcribe.h"
 
-/* We use a tree-like data structure to describe transcriptions.  Each node has
- * 256 children (typically nil, indicated by 0).  Each node represents what to
- * do if an input string contains the subsequence indicated from the root to
- * the current node.  If the subsequence continues, we go to the appropriate
- * child.  If not, the node contains a replacement string that should
- * substitute for the input string.
+/* The left strings are first gathered in a trie of code points: each node has
+ * a sorted array of the characters that continue some left string, and the
+ * replacement of the left string that ends there, if any.  Once the file is
+ * read, the trie is compiled into the automaton that transcribe() runs: an
+ * array of states, each with a contiguous run of transitions in one shared
+ * array, sorted by character.  Compiling works from the leaves up and stores
+ * identical states only once, so the automaton is the minimal one for the
+ * rules; left strings that end alike, as with "tion" and "sion", share their
+ * tails.  A state costs 16 bytes and a transition 8, instead of 2K for each
+ * byte of each character in a 256-way trie.
+ *
+ * Transcribing works a character at a time.  From each position, the automaton
+ * follows the source as far as it can, remembering the last state at which a
+ * left string ended; that longest match, if any, is replaced and the scan goes
+ * on after it, otherwise the character is copied.  No Aho-Corasick failure
+ * links are needed, because a match that starts later never wins over one that
+ * starts earlier.  Left strings are short, so a position costs a few steps at
+ * most, and most positions cost one test of startMask.
  */
 
+// Make room for needed elements in *array, which has room for *room.
+template <typename element_t> static void growArray(element_t **array,
+		int *room, const int needed) {
+	int newRoom;
+	element_t *newArray;
+	if (needed <= *room) return;
+	newRoom = *room ? 2 * *room : 16;
+	while (newRoom < needed) newRoom *= 2;
+	newArray = reinterpret_cast<element_t *>(
+		realloc(*array, newRoom*sizeof(element_t)));
+	if (newArray == NULL) throw(uSpell::noMem);
+	*array = newArray;
+	*room = newRoom;
+} // growArray
+
 transcriber::transcriber(const char *fileName) {
-	memset(reinterpret_cast<void *>(&transcribeStart), 0, sizeof(transcribeStart));
 	FILE *transcriptionFile;
+	int registryLength, *registry, index;
+	rules = reinterpret_cast<ruleNode_t *>(calloc(sizeof(ruleNode_t), 1));
+	states = NULL;
+	transitions = NULL;
+	replacements = NULL;
+	ruleNodeCount = 1;
+	stateCount = stateRoom = transitionCount = transitionRoom = 0;
+	replacementLength = replacementRoom = 0;
+	startState = -1;
+	startMask = 0;
+	if (rules == NULL) throw(uSpell::noMem);
 	if (!*fileName) return; // we can do without a transcription file.
 	transcriptionFile = fopen(fileName, "r");
 	utf8_t buf[BUFLEN];
@@ -41,127 +80,240 @@ transcriber::transcriber(const char *fileName) {
 		divide = reinterpret_cast<utf8_t *>(
 			strrchr(reinterpret_cast<char *>(buf), ' '));
 		if (divide) {
-			wide_t *orig, *replace;
-			wide_t bigBuf[BUFLEN];
+			wide_t orig[BUFLEN], replace[BUFLEN];
 			int origLength, replaceLength;
 			*divide++ = 0;
-			origLength = utf8_wide(bigBuf, buf, BUFLEN);
-			orig = reinterpret_cast<wide_t *>(malloc(origLength*4));
-			memcpy(orig, bigBuf, sizeof(wide_t)*origLength);
-			replaceLength = utf8_wide(bigBuf, divide, BUFLEN);
-			replace = reinterpret_cast<wide_t *>(malloc(replaceLength*4));
-			memcpy(replace, bigBuf, sizeof(wide_t)*replaceLength);
+			origLength = utf8_wide(orig, buf, BUFLEN);
+			replaceLength = utf8_wide(replace, divide, BUFLEN);
 			addTranscribe(orig, origLength, replace, replaceLength);
 		} else {
 			fprintf(stderr, "Bad transcription file line: %s\n", buf);
 		}
 	} // one spec
 	fclose(transcriptionFile);
+	// compile the trie; the registry is at most half full
+	for (registryLength = 16; registryLength < 2 * ruleNodeCount;
+		registryLength *= 2);
+	registry = reinterpret_cast<int *>(malloc(registryLength*sizeof(int)));
+	if (registry == NULL) throw(uSpell::noMem);
+	memset(registry, 0xff, registryLength*sizeof(int)); // all -1: empty
+	startState = compile(rules, registry, registryLength - 1);
+	free(registry);
+	recursiveFree(rules);
+	rules = NULL;
+	if (states[startState].transitionCount == 0) { // no rules
+		startState = -1;
+		return;
+	}
+	for (index = 0; index < states[startState].transitionCount; index += 1) {
+		startMask |= 1ULL << (transitions[states[startState].firstTransition +
+			index].character & 63);
+	}
 } // transcriber
 
-void transcriber::recursiveFree(transcribe_t *aNode) {
+void transcriber::recursiveFree(ruleNode_t *aNode) {
 	int index;
-	for (index = 0; index < 256; index += 1) {
-		if (aNode->nextState[index]) {
-			recursiveFree(aNode->nextState[index]);
-			free(aNode->nextState[index]);
-		}
+	for (index = 0; index < aNode->count; index += 1) {
+		recursiveFree(aNode->children[index]);
 	}
+	free(aNode->characters);
+	free(aNode->children);
+	free(const_cast<wide_t *>(aNode->replacement));
+	free(aNode);
 } // recursiveFree
 
 transcriber::~transcriber() { // deallocator
 	// fprintf(stdout, "deallocating transcriber\n");
-	recursiveFree(&transcribeStart);
+	if (rules) recursiveFree(rules);
+	free(states);
+	free(transitions);
+	free(replacements);
 } // deallocator
 
 void transcriber::addTranscribe(const wide_t* orig, int origLength,
 		const wide_t* replace, const int replaceLength) {
-	transcribe_t *current;
-	const char *sourcePtr;
-	int index;
-	unsigned int count;
+	ruleNode_t *current;
+	wide_t *copy;
+	int count, index;
 	// fprintf(stdout, "adding transcription %s ", makeUTF((wide_t *) orig,
 	// 	origLength));
 	// fprintf(stdout, "-> %s\n", makeUTF((wide_t *) replace, replaceLength));
-	current = &transcribeStart;
-	for (count = 0, sourcePtr = reinterpret_cast<const char *>(orig);
-			count < sizeof(wide_t)*origLength; count += 1, sourcePtr++)
-	{ // one char of orig
-		index = *sourcePtr & 0xff;
-		// fprintf(stdout, " %x ", index);
-		if (!(current->nextState[index])) {
-			current->nextState[index] =
-				reinterpret_cast<transcribe_t *>(
-					calloc(sizeof(transcribe_t), 1));
-			// fprintf(stdout, " ! ");
+	current = rules;
+	for (count = 0; count < origLength; count += 1) { // one char of orig
+		for (index = 0; index < current->count &&
+			current->characters[index] < orig[count]; index += 1);
+		if (index == current->count ||
+				current->characters[index] != orig[count]) { // new child
+			wide_t *newCharacters = reinterpret_cast<wide_t *>(
+				realloc(current->characters,
+				(current->count + 1) * sizeof(wide_t)));
+			if (newCharacters == NULL) throw(uSpell::noMem);
+			current->characters = newCharacters;
+			ruleNode_t **newChildren = reinterpret_cast<ruleNode_t **>(
+				realloc(current->children,
+				(current->count + 1) * sizeof(ruleNode_t *)));
+			if (newChildren == NULL) throw(uSpell::noMem);
+			current->children = newChildren;
+			memmove(current->characters + index + 1,
+				current->characters + index,
+				(current->count - index) * sizeof(wide_t));
+			memmove(current->children + index + 1, current->children + index,
+				(current->count - index) * sizeof(ruleNode_t *));
+			current->characters[index] = orig[count];
+			current->children[index] = reinterpret_cast<ruleNode_t *>(
+				calloc(sizeof(ruleNode_t), 1));
+			if (current->children[index] == NULL) throw(uSpell::noMem);
+			current->count += 1;
+			ruleNodeCount += 1;
 		}
-		current = current->nextState[index];
+		current = current->children[index];
 	} // one char of orig
-	// fprintf(stdout, "\n");
 	if (current->length) {
 		fprintf(stdout, "conflict; %s already ",
-			makeUTF(reinterpret_cast<const wide_t *>(orig), origLength));
+			makeUTF(orig, origLength));
 		fprintf(stdout, " -> %s",
-			makeUTF(reinterpret_cast<const wide_t *>(current->replacement),
-			current->length));
+			makeUTF(current->replacement, current->length));
 		fprintf(stdout, ", not %s\n",
-			makeUTF(reinterpret_cast<const wide_t *>(replace), replaceLength));
+			makeUTF(replace, replaceLength));
 		return;
 	}
-	current->replacement = replace;
+	if (replaceLength == 0) return; // nothing to replace with
+	copy = reinterpret_cast<wide_t *>(malloc(replaceLength*sizeof(wide_t)));
+	if (copy == NULL) throw(uSpell::noMem);
+	memcpy(copy, replace, replaceLength*sizeof(wide_t));
+	current->replacement = copy;
 	current->length = replaceLength;
 } // addTranscribe
 
+// Compile the trie at aNode into the automaton and return its state.  The
+// registry, of registryMask+1 entries, holds the states so far by their hash,
+// so that a state identical to an earlier one is not stored again.
+int transcriber::compile(ruleNode_t *aNode, int *registry,
+		const int registryMask) {
+	int first, index, slot, candidate;
+	ub4 hashValue;
+	state_t *state;
+	// the children first, so their states are final
+	int *children = reinterpret_cast<int *>(
+		malloc((aNode->count + 1) * sizeof(int)));
+	if (children == NULL) throw(uSpell::noMem);
+	for (index = 0; index < aNode->count; index += 1) {
+		children[index] = compile(aNode->children[index], registry,
+			registryMask);
+	}
+	// the transitions, tentatively at the end of the array
+	first = transitionCount;
+	growArray(&transitions, &transitionRoom, first + aNode->count);
+	for (index = 0; index < aNode->count; index += 1) {
+		transitions[first + index].character = aNode->characters[index];
+		transitions[first + index].state = children[index];
+	}
+	free(children);
+	hashValue = hash(reinterpret_cast<ub1 *>(transitions + first),
+		aNode->count * sizeof(transition_t),
+		hash(reinterpret_cast<ub1 *>(const_cast<wide_t *>(
+			aNode->replacement)), aNode->length * sizeof(wide_t), 0));
+	for (slot = hashValue & registryMask; registry[slot] >= 0;
+			slot = (slot + 1) & registryMask) { // one registered state
+		candidate = registry[slot];
+		state = states + candidate;
+		if (state->transitionCount == aNode->count &&
+				state->length == aNode->length &&
+				(aNode->count == 0 || !memcmp(transitions +
+					state->firstTransition, transitions + first,
+					aNode->count * sizeof(transition_t))) &&
+				(aNode->length == 0 || !memcmp(replacements +
+					state->replacement, aNode->replacement,
+					aNode->length * sizeof(wide_t)))) {
+			return(candidate); // its transitions are dropped
+		}
+	} // one registered state
+	transitionCount = first + aNode->count;
+	growArray(&states, &stateRoom, stateCount + 1);
+	state = states + stateCount;
+	state->firstTransition = first;
+	state->transitionCount = aNode->count;
+	state->replacement = replacementLength;
+	state->length = aNode->length;
+	growArray(&replacements, &replacementRoom,
+		replacementLength + aNode->length);
+	if (aNode->length) {
+		memcpy(replacements + replacementLength, aNode->replacement,
+			aNode->length * sizeof(wide_t));
+	}
+	replacementLength += aNode->length;
+	registry[slot] = stateCount;
+	return(stateCount++);
+} // compile
+
+// The state that c leads to from state, or -1.
+inline int transcriber::nextState(const int state, const wide_t c) {
+	const transition_t *low = transitions + states[state].firstTransition;
+	const transition_t *high = low + states[state].transitionCount;
+	while (high - low > 4) { // binary search down to a few
+		const transition_t *middle = low + (high - low) / 2;
+		if (middle->character <= c) {
+			low = middle;
+		} else {
+			high = middle;
+		}
+	}
+	for (; low < high; low++) {
+		if (low->character == c) return(low->state);
+	}
+	return(-1);
+} // nextState
+
 // transcribe the source into dest.  We assume there is room.  Return the
 // length of the result.
 void transcriber::transcribe(wide_t *dest, int *destLength,
 		const wide_t *source, const int sourceLength) {
-	// although the parameters (and lengths!) are in wide_t, we work a byte at
-	// a time.
-	transcribe_t *current;
-	const unsigned char *aftSource, *foreSource;
-	wide_t *destPtr;
-	int index;
-	const wide_t *replacePtr;
-	current = &transcribeStart;
-	aftSource = reinterpret_cast<const unsigned char *>(source);
-	foreSource = reinterpret_cast<const unsigned char *>(source);
-	destPtr = dest;
-	while ((reinterpret_cast<const wide_t *>(foreSource)) <
-			(reinterpret_cast<const wide_t *>(source))+sourceLength) {
-		// one char of source
-		index = *foreSource & 0xff;
-		if ((current->nextState[index])) { // the path continues
-			current = current->nextState[index];
-			foreSource++;
-		} else if (current->length) { // end of path; replace
-			int count;
-			for (count = 0, replacePtr = current->replacement;
-					count < current->length; replacePtr++, count += 1) {
-				*destPtr++ = *replacePtr;
-			}
-			aftSource = foreSource;
-			current = &transcribeStart;
-		} else { // no replacement; output one byte and rescan
-			char * foo = reinterpret_cast<char *>(destPtr);
-			*(foo)++ = *aftSource++;
-			foreSource = aftSource;
-			current = &transcribeStart;
+	wide_t *destPtr = dest;
+	int position, index, state, matchEnd, matchState;
+	if (startState < 0) { // no rules
+		memcpy(dest, source, sourceLength*sizeof(wide_t));
+		*destLength = sourceLength;
+		return;
+	}
+	for (position = 0; position < sourceLength;) { // one match or character
+		wide_t c = source[position];
+		if (!((startMask >> (c & 63)) & 1) ||
+				(state = nextState(startState, c)) < 0) { // no left string
+			*destPtr++ = c;
+			position += 1;
+			continue;
 		}
-	} // one char of source
-	// close loose ends
-	if (current->length) {
-		int count;
-		for (count = 0, replacePtr = current->replacement;
-				count < current->length; replacePtr++, count += 1) {
-			*destPtr++ = *replacePtr;
+		matchEnd = -1;
+		matchState = 0;
+		for (index = position + 1; ; index += 1) { // follow the source
+			if (states[state].length) { // a left string ends here
+				matchEnd = index;
+				matchState = state;
+			}
+			if (index == sourceLength ||
+					(state = nextState(state, source[index])) < 0) break;
+		} // follow the source
+		if (matchEnd < 0) { // only the start of a left string
+			*destPtr++ = c;
+			position += 1;
+		} else {
+			memcpy(destPtr, replacements + states[matchState].replacement,
+				states[matchState].length * sizeof(wide_t));
+			destPtr += states[matchState].length;
+			position = matchEnd;
 		}
-	} else {
-		for (replacePtr = reinterpret_cast<const wide_t *>(aftSource);
-			replacePtr < reinterpret_cast<const wide_t *>(foreSource);
-			replacePtr++) {
-		*destPtr++ = *replacePtr;
-	}
-}
-*destLength = destPtr - dest;
+	} // one match or character
+	*destLength = destPtr - dest;
 } // transcribe
+
+bool transcriber::hasRules() {
+	return(startState >= 0);
+} // hasRules
+
+void transcriber::reportStatistics(FILE *outFile) {
+	fprintf(outFile, "transcriber: %d states, %d transitions, %lu bytes\n",
+		stateCount, transitionCount, static_cast<unsigned long>(
+			stateCount * sizeof(state_t) +
+			transitionCount * sizeof(transition_t) +
+			replacementLength * sizeof(wide_t)));
+} // reportStatistics
@@ -5,6 +5,7 @@
 #ifndef TRANSCRIBE_H
 #define TRANSCRIBE_H
 
+#include <stdio.h>
 #include "myparameters.h"
 #include "mytypes.h"
 
@@ -16,25 +17,55 @@ class transcriber {
 			// line per transcription, with a single space character in the
 			// middle, and the left and right string both in UTF-8.
 			// Transcribing a string converts all occurrences of any left
-			// string into its associated right string.
+			// string into its associated right string.  Where left strings
+			// overlap, the one that starts first wins, and of those, the
+			// longest.
 		~transcriber(); // deallocator
 		void transcribe(wide_t *dest, int *destLength, const wide_t *source,
 			const int sourceLength);
 			// the lengths are in wide_t units, not bytes.
+		bool hasRules();
+			// false if transcribing has no effect.
+		void reportStatistics(FILE *outFile);
+			// describes the automaton: its states, transitions and size.
 	private:
 	// types
-		typedef struct transcribeStruct {
-			struct transcribeStruct *nextState[256];
+		typedef struct ruleNode {
+			wide_t *characters; // sorted
+			struct ruleNode **children; // parallel to characters
+			int count; // of children
 			const wide_t *replacement;
-			int length; // (in wide_t units) if not zero, there is a replacement
-				// here.
-		} transcribe_t;
+			int length; // (in wide_t units) if not zero, there is a
+				// replacement here.
+		} ruleNode_t; // a node of the trie of rules, while it is built
+		typedef struct {
+			wide_t character;
+			int state; // the state that character leads to
+		} transition_t;
+		typedef struct {
+			int firstTransition; // in transitions, sorted by character
+			int transitionCount;
+			int replacement; // where it starts in replacements
+			int length; // of the replacement; 0 if no rule ends here
+		} state_t;
 	// vars
-		transcribe_t transcribeStart;
+		ruleNode_t *rules; // the trie, until it is compiled; then NULL
+		int ruleNodeCount; // nodes in it
+		state_t *states; // the automaton; NULL if there are no rules
+		int stateCount, stateRoom;
+		transition_t *transitions;
+		int transitionCount, transitionRoom;
+		wide_t *replacements; // the right strings, end to end
+		int replacementLength, replacementRoom;
+		int startState;
+		__uint64_t startMask; // bit c%64 is on if the start state has a
+			// transition on some character c
 	// methods
 		void addTranscribe(const wide_t* orig, int origLength,
 		const wide_t* replace, const int replaceLength);
-		void recursiveFree(transcribe_t *aNode);
+		void recursiveFree(ruleNode_t *aNode);
+		int compile(ruleNode_t *aNode, int *registry, const int registryMask);
+		int nextState(const int state, const wide_t c);
 }; // transcriber
 
 #endif // TRANSCRIBE
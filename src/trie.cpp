@@ -0,0 +1,248 @@
+// trie.cpp
+// license: Gnu Public License.
+//
+// The trie engine for suggestions.  By default showAlternatives() looks up
+// variants of the misspelling in the reducedWordTable, which finds only words
+// that share a variant with it, and scores whatever else shares the chains.
+// After suggestWithin(d), it instead walks a trie of the reduced forms of all
+// the words and finds exactly those whose reduced forms are within d edits of
+// the misspelling's, fewest edits first; words with as many edits are ranked
+// by wordDiff(), as the hash engine ranks all its words.  An edit is an
+// insertion, omission or replacement of a character, or a transposition of
+// two adjacent ones, which the hash engine looks up as well.
+//
+// The trie is built from the word columns the first time it is chosen, so
+// an image needs nothing more; words added later join it as they get ids.
+// Its nodes are in one array, each with the alphabet code that leads to it,
+// its first child and its next sibling; a node where reduced forms end heads
+// a list of their words, linked by trieNextWords.
+//
+// The walk simulates a Levenshtein automaton for the reduced misspelling of m
+// codes, bit-parallel: state k is a word of m+1 bits, where bit i is on if the
+// first i codes of the misspelling are within k edits of the path so far.
+// Each code of the path updates the d+1 states with a few shifts and ORs
+// (Wu and Manber); a transposition also needs the states and code of the
+// parent.  A word at a node is within k edits if bit m of state k is on, and
+// a subtree is skipped once state d is empty.  The walk is made with d = 0,
+// 1 and so on, each pass suggesting only the words d edits away, and stops
+// once words that far can no longer beat the worst suggestion; a misspelling
+// with enough close neighbours never pays for the wide walk, which visits
+// thousands of nodes.  Misspellings of more than maxTrieLength codes are
+// left to the hash engine.
+//
+// escapeCode stands for many characters, so the automaton takes it to match
+// itself; a word that has it, found for a misspelling that has it, is
+// decoded and reduced again and its distance computed character by
+// character.
+//
+// 	uSpell::suggestWithin: chooses the engine
+// 	uSpell::insertTrie: adds a word
+// 	uSpell::trieOpen, uSpell::walkTrie, uSpell::addTrieWords,
+// 		uSpell::trieAlternatives: suggestions
+
+#include <string.h>
+#include <stdlib.h>
+#include "uspell.h"
+#include "utf8convert.h"
+#include "editdistance.h"
+
+void uSpell::suggestWithin(const int distance) {
+	trieNode_t *newNodes;
+	int newCount;
+	wordId_t wordId;
+	trieDistance = distance < 0 ? 0 :
+		distance > maxDistance ? maxDistance : distance;
+	if (trieDistance == 0 || trieNodes != NULL) return;
+	// build the trie from the words we have
+	trieNodeRoom = 1024;
+	trieNodes = reinterpret_cast<trieNode_t *>(
+		malloc(trieNodeRoom * sizeof(trieNode_t)));
+	if (trieNodes == NULL) throw(noMem);
+	memset(&trieNodes[0], 0, sizeof(trieNodes[0])); // the root
+	trieNodeCount = 1;
+	for (wordId = 1; wordId < wordCount; wordId += 1) {
+		insertTrie(wordId);
+	}
+	// lay it out again so that siblings are adjacent, in depth-first order
+	newNodes = reinterpret_cast<trieNode_t *>(
+		malloc(trieNodeRoom * sizeof(trieNode_t)));
+	if (newNodes == NULL) throw(noMem);
+	newNodes[0] = trieNodes[0];
+	newCount = 1;
+	placeChildren(trieNodes, newNodes, 0, &newCount);
+	free(trieNodes);
+	trieNodes = newNodes;
+} // suggestWithin
+
+// Copy the children of node from oldNodes to newNodes, where node is already,
+// followed by their descendants; count is the nodes placed in newNodes.  The
+// children of node are linked in oldNodes.
+void uSpell::placeChildren(const trieNode_t *oldNodes, trieNode_t *newNodes,
+		const int node, int *count) {
+	int child, first, last, index;
+	first = *count;
+	for (child = newNodes[node].firstChild; child;
+			child = oldNodes[child].nextSibling) {
+		newNodes[*count] = oldNodes[child];
+		newNodes[*count].nextSibling = *count + 1;
+		*count += 1;
+	}
+	last = *count;
+	if (last == first) return; // no children
+	newNodes[last - 1].nextSibling = 0;
+	newNodes[node].firstChild = first;
+	for (index = first; index < last; index += 1) {
+		placeChildren(oldNodes, newNodes, index, count);
+	}
+} // placeChildren
+
+// Add the word to the trie, under its reduced form.
+void uSpell::insertTrie(const wordId_t wordId) {
+	const unsigned char *reduced = reducedBlob + reducedStarts[wordId];
+	int index, node, child;
+	node = 0;
+	for (index = 0; index < reducedLengths[wordId]; index += 1) {
+		for (child = trieNodes[node].firstChild; child;
+				child = trieNodes[child].nextSibling) {
+			if (trieNodes[child].code == reduced[index]) break;
+		}
+		if (child == 0) { // a new node, first of its siblings
+			if (trieNodeCount >= trieNodeRoom) {
+				trieNode_t *newNodes = reinterpret_cast<trieNode_t *>(
+					realloc(trieNodes, 2*trieNodeRoom*sizeof(trieNode_t)));
+				if (newNodes == NULL) throw(noMem);
+				trieNodes = newNodes;
+				trieNodeRoom *= 2;
+			}
+			child = trieNodeCount++;
+			trieNodes[child].firstChild = 0;
+			trieNodes[child].nextSibling = trieNodes[node].firstChild;
+			trieNodes[child].firstWord = 0;
+			trieNodes[child].code = reduced[index];
+			trieNodes[node].firstChild = child;
+		}
+		node = child;
+	}
+	if (wordId >= trieNextRoom) { // grow the links
+		wordId_t newRoom = wordId < 512 ? 1024 : 2*wordId;
+		wordId_t *newLinks = reinterpret_cast<wordId_t *>(
+			realloc(trieNextWords, newRoom*sizeof(wordId_t)));
+		if (newLinks == NULL) throw(noMem);
+		trieNextWords = newLinks;
+		trieNextRoom = newRoom;
+	}
+	trieNextWords[wordId] = 0; // it goes last, so ties go to earlier words
+	if (trieNodes[node].firstWord == 0) {
+		trieNodes[node].firstWord = wordId;
+	} else {
+		wordId_t last;
+		for (last = trieNodes[node].firstWord; trieNextWords[last];
+				last = trieNextWords[last]) {
+			// find the end of the list
+		}
+		trieNextWords[last] = wordId;
+	}
+} // insertTrie
+
+// Suggest the words that end at node, whose reduced forms are distance edits
+// from the probe's as far as the automaton can tell.  Their goodness is the
+// edit distance, scaled by trieTieScale, plus their wordDiff().
+void uSpell::addTrieWords(const int node, const int distance,
+		const trieProbe_t *probe) {
+	wordId_t wordId;
+	int exact, tie;
+	for (wordId = trieNodes[node].firstWord; wordId;
+			wordId = trieNextWords[wordId]) {
+		if (wordOffsets[wordId] == removedWord) continue;
+		scoredCandidates += 1;
+		exact = distance;
+		if (probe->target->escaped && memchr(reducedBlob +
+				reducedStarts[wordId], escapeCode, reducedLengths[wordId])) {
+			// escapeCode may stand for different characters; compare the
+			// characters themselves
+			wide_t bigBuf[BUFLEN], reduceBuf[BUFLEN];
+			int bigLength, reduceLength;
+			bigLength = utf8_wide(bigBuf, wordAt(wordId), wordLengths[wordId],
+				BUFLEN);
+			reduceWord(reduceBuf, &reduceLength, bigBuf, bigLength,
+				myTranscribe);
+			exact = editDistance(reduceBuf, reduceLength,
+				probe->target->characters, probe->target->length);
+			if (exact > trieDistance) continue; // later passes skip it
+		}
+		// of words as close, prefer those wordDiff() finds closer
+		wordDiffs(probe->target, &wordId, 1, &tie, trieTieScale - 1);
+		if (tie >= trieTieScale) tie = trieTieScale - 1;
+		addSuggestion(wordId, exact * trieTieScale + tie);
+	}
+} // addTrieWords
+
+// Return whether a word distance edits from the probe could still join the
+// suggestions.
+bool uSpell::trieOpen(const int distance) {
+	return(acceptableGoodness() >= distance * trieTieScale);
+} // trieOpen
+
+// Visit the children of node, whose path leaves the automaton in states[],
+// and the path of its parent in before[], and suggest the words exactly the
+// distance of probe away.  Returns false once none can join the suggestions.
+bool uSpell::walkTrie(const int node, const __uint64_t *states,
+		const __uint64_t *before, const trieProbe_t *probe) {
+	__uint64_t next[maxDistance+1];
+	int child, level;
+	const int distance = probe->distance;
+	const __uint64_t previous = probe->target->masks[trieNodes[node].code]
+		<< 1; // 0 at the root, whose code is 0
+	for (child = trieNodes[node].firstChild; child;
+			child = trieNodes[child].nextSibling) {
+		const __uint64_t match = probe->target->masks[trieNodes[child].code]
+			<< 1;
+		next[0] = (states[0] << 1) & match;
+		for (level = 1; level <= distance; level += 1) {
+			next[level] = (((states[level] << 1) & match) |
+				states[level-1] | (states[level-1] << 1) |
+				(next[level-1] << 1) |
+				((before[level-1] << 2) & (match << 1) & previous)) &
+				probe->live;
+				// match, insert, replace, omit, transpose
+		}
+		if (next[distance] == 0) continue; // nothing below can be close
+		trieVisits += 1;
+		if (trieNodes[child].firstWord && (next[distance] & probe->accept) &&
+				(distance == 0 || !(next[distance-1] & probe->accept))) {
+			// closer words were suggested by an earlier pass
+			addTrieWords(child, distance, probe);
+			if (!trieOpen(distance)) return(false);
+		}
+		if (trieNodes[child].firstChild &&
+				!walkTrie(child, next, states, probe)) {
+			return(false);
+		}
+	}
+	return(true);
+} // walkTrie
+
+// Add to suggestions[] the words within trieDistance of the target, in
+// passes of one more edit each, while such words could still join them.
+void uSpell::trieAlternatives(const target_t *target) {
+	trieProbe_t probe;
+	__uint64_t states[maxDistance+1], before[maxDistance+1];
+	int level;
+	probe.accept = static_cast<__uint64_t>(1) << target->length;
+	probe.live = (probe.accept << 1) - 1;
+	probe.target = target;
+	trieLookups += 1;
+	for (level = 0; level <= trieDistance; level += 1) { // omit level codes
+		states[level] = ((static_cast<__uint64_t>(2) << level) - 1) &
+			probe.live;
+		before[level] = 0;
+	}
+	for (probe.distance = 0; probe.distance <= trieDistance &&
+			trieOpen(probe.distance); probe.distance += 1) {
+		if (trieNodes[0].firstWord && target->length == probe.distance) {
+			// words with nothing left after reduction
+			addTrieWords(0, probe.distance, &probe);
+		}
+		walkTrie(0, states, before, &probe);
+	}
+} // trieAlternatives
@@ -20,11 +20,22 @@ void unPrecompose(wide_t *dest, int *destLength, const wide_t *source,
   * their base and combining forms.
   */
 void reduce(wide_t *dest, int *destLength, const wide_t *source,
-	int sourceLength, class transcriber *transcribePtr);
+	int sourceLength, class transcriber *transcribePtr,
+	const bool expandPrecomposed);
  /* To "reduce" a word w -> r(w) means to remove all combining characters
   * (typically accent marks), to reduce precomposed letters to their base
-  * forms, and to substitute any language-specific transcriptions.  The
-  * transcribePtr may be NULL, in which case no transcription is done.
+  * forms if expandPrecomposed, and to substitute any language-specific
+  * transcriptions.  The transcribePtr may be NULL, in which case no
+  * transcription is done.  r(w) is the same as the reduction of
+  * unPrecompose(w) without expandPrecomposed.
+  */
+typedef void (*reducer_t)(wide_t *dest, int *destLength, const wide_t *source,
+	int sourceLength, class transcriber *transcribePtr);
+reducer_t reducerFor(const bool expandPrecomposed, const bool transcribing);
+ /* reduce(), specialized for a language, without the tests of its flags.
+  * The answer needs a transcribePtr with rules if transcribing, and ignores
+  * it otherwise.  An application that reduces many words should choose the
+  * reducer once.
   */
 void toUpper(wide_t *dest, const wide_t *source, int sourceLength);
  /* change all chars to upper case.  sourceLength is in wide_t units, not
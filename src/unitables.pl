@@ -0,0 +1,164 @@
+#!/usr/bin/perl
+# unitables.pl: generate unitables.h, the Unicode property tables of
+# uniprops.cpp, from the Unicode Character Database that comes with perl.
+# Usage: perl unitables.pl > unitables.h  ("make unitables" in src does so)
+#
+# The properties of each character are found by a two-stage lookup: the high
+# bits of the character select a block of 128 entries in the second stage,
+# and the low bits select the entry.  Identical blocks are stored once, so
+# unassigned and uniform stretches of the code space cost nothing.  For the
+# properties, the entry is the index of a record of flags and case and final
+# deltas; for precomposed letters, it is 1 + the index of the letter in
+# precomposeTable, or 0.
+#
+# The properties are these:
+#	combining: general category Mn, Mc or Me
+#	alphabetic: general category L* or M*
+#	upper: the simple uppercase mapping
+#	final: for a letter X, the letter whose name is X's with FINAL added
+#		before or after LETTER, such as HEBREW LETTER FINAL KAF for
+#		HEBREW LETTER KAF
+#	precomposed: a letter with a canonical decomposition into two
+#		characters, except Hangul syllables, which decompose
+#		algorithmically
+#
+# license: Gnu Public License.
+
+use strict;
+use warnings;
+use Unicode::UCD qw(prop_invmap);
+
+my $shift = 7; # bits of a character that select an entry within a block
+my $limit = 0x110000; # characters
+
+# The value of property for every character, as an array.
+sub expand {
+	my ($property) = @_;
+	my ($list, $map, $format, $default) = prop_invmap($property);
+	die "unitables.pl: no property $property\n" unless defined $list;
+	my @values;
+	for my $index (0 .. $#$list) {
+		my $end = $index < $#$list ? $list->[$index+1] : $limit;
+		for my $char ($list->[$index] .. $end - 1) {
+			my $value = $map->[$index];
+			# in an adjusted map, a range maps to consecutive characters
+			if ($format =~ /^a/ && !ref($value) && $value =~ /^\d+$/ &&
+					$value != 0) {
+				$value += $char - $list->[$index];
+			}
+			$values[$char] = $value;
+		}
+	}
+	return(\@values);
+} # expand
+
+# Print the name of an array of C type type, and its values.
+sub printArray {
+	my ($type, $name, $values) = @_;
+	my $perLine = $type eq 'unsigned char' ? 16 : 12;
+	print "static const $type ${name}[] = {\n";
+	for (my $index = 0; $index < @$values; $index += $perLine) {
+		my $last = $index + $perLine - 1;
+		$last = $#$values if $last > $#$values;
+		print "\t", join(', ', map { sprintf('0x%x', $_) }
+			@$values[$index .. $last]), ",\n";
+	}
+	print "}; // $name\n\n";
+} # printArray
+
+# Print the two stages of a lookup table for values, which are numbers.
+# Characters at and beyond the last nonzero value get 0 without a lookup.
+sub printStages {
+	my ($name, $type, $values) = @_;
+	my $top = $#$values;
+	$top -= 1 while $top >= 0 && !$values->[$top];
+	my $blockSize = 1 << $shift;
+	my $blocks = int(($top + $blockSize) / $blockSize);
+	my (@stage1, @stage2, %blockNumbers);
+	for my $block (0 .. $blocks - 1) {
+		my @entries = map { $values->[$_] || 0 }
+			($block * $blockSize .. ($block+1) * $blockSize - 1);
+		my $key = join(',', @entries);
+		if (!exists($blockNumbers{$key})) {
+			$blockNumbers{$key} = @stage2 / $blockSize;
+			push(@stage2, @entries);
+		}
+		push(@stage1, $blockNumbers{$key});
+	}
+	printf("static const wide_t %sLimit = 0x%x;\n\n", $name,
+		$blocks * $blockSize);
+	printArray('unsigned short', "${name}Stage1", \@stage1);
+	printArray($type, "${name}Stage2", \@stage2);
+} # printStages
+
+my $category = expand('General_Category');
+my $upper = expand('Simple_Uppercase_Mapping');
+my $decompositionType = expand('Decomposition_Type');
+my $decomposition = expand('Decomposition_Mapping');
+
+# final forms, by name
+my (%named, %final);
+{
+	my ($list, $map) = prop_invmap('Name');
+	for my $index (0 .. $#$list - 1) {
+		next if $list->[$index+1] - $list->[$index] != 1 ||
+			ref($map->[$index]) || $map->[$index] eq '';
+		$named{$map->[$index]} = $list->[$index];
+	}
+	for my $name (keys %named) {
+		my $base = $name;
+		next unless $base =~ s/ LETTER FINAL / LETTER / ||
+			$base =~ s/ FINAL LETTER / LETTER /;
+		$final{$named{$base}} = $named{$name} if exists($named{$base});
+	}
+}
+
+# property records; record 0 is a character without properties
+my (@records, %recordNumbers, @propertyIndex, @precomposeIndex, @precompose);
+my ($combiningFirst, $precomposeFirst); # the first such characters
+push(@records, '0, 0, 0');
+$recordNumbers{'0, 0, 0'} = 0;
+for my $char (0 .. $limit - 1) {
+	my $flags = 0;
+	$flags |= 1 if $category->[$char] =~ /^M/; # combiningFlag
+	$combiningFirst = $char if $flags & 1 && !defined($combiningFirst);
+	$flags |= 2 if $category->[$char] =~ /^[LM]/; # alphabeticFlag
+	my $upperDelta = defined($upper->[$char]) && $upper->[$char] =~ /^\d+$/ &&
+		$upper->[$char] != 0 ? $upper->[$char] - $char : 0;
+	my $finalDelta = exists($final{$char}) ? $final{$char} - $char : 0;
+	my $record = "$flags, $upperDelta, $finalDelta";
+	if (!exists($recordNumbers{$record})) {
+		$recordNumbers{$record} = @records;
+		push(@records, $record);
+	}
+	$propertyIndex[$char] = $recordNumbers{$record};
+	next if $category->[$char] !~ /^L/ ||
+		$decompositionType->[$char] ne 'Canonical' ||
+		($char >= 0xAC00 && $char <= 0xD7A3);
+	my $parts = $decomposition->[$char];
+	my @parts = ref($parts) ? @$parts : map { hex } split(' ', $parts);
+	if (@parts == 2) {
+		push(@precompose, sprintf('{0x%04X, 0x%04X, 0x%04X}', $char,
+			@parts));
+		$precomposeIndex[$char] = scalar(@precompose);
+		$precomposeFirst = $char if !defined($precomposeFirst);
+	}
+}
+die "unitables.pl: too many property records\n" if @records > 256;
+
+print "// unitables.h\n";
+print "// Generated by unitables.pl from the Unicode Character Database ",
+	Unicode::UCD::UnicodeVersion(), ".\n";
+print "// Don't edit it; run \"make unitables\" in src instead.\n";
+print "// license: Gnu Public License.\n\n";
+printf("// characters below these have no combining or precomposed forms\n");
+printf("static const wide_t combiningFirst = 0x%x;\n", $combiningFirst);
+printf("static const wide_t precomposeFirst = 0x%x;\n\n", $precomposeFirst);
+print "static const uniProperty_t uniProperties[] = {\n";
+print "\t{$_},\n" for @records;
+print "}; // uniProperties\n\n";
+printStages('property', 'unsigned char', \@propertyIndex);
+print "static const precomposeStruct precomposeTable[] = {\n";
+print "\t$_,\n" for @precompose;
+print "}; // precomposeTable\n\n";
+printStages('precompose', 'unsigned short', \@precomposeIndex);
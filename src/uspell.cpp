@@ -9,7 +9,8 @@
 // 	~uSpell: finalizes, deallocates the (fairly large) data structures
 // 	assimilateFile: incorporates another dictionary file, such as a personal
 // 		dictionary.
-//	isSpelledRight: tells if a given word is found in the dictionary.
+//	isSpelledRight: tells if a given word is found in the dictionary; the UTF8
+//		form looks the word up without converting it.
 //	isSpelledRightMultiple: tells if a given word is found in the dictionary,
 //		possibly by decomposing it into two words, both spelled right.
 //	ignoreWord: adds word to the dictionary, but not as a possible suggestion
@@ -17,289 +18,807 @@
 //	acceptWord: adds word to the dictionary and as a possible suggestion for
 //		misspelled words.
 //	showAlternatives: lists all close alternatives to a given misspelled word
+//	suggestWithin: chooses how showAlternatives finds them; see trie.cpp
+//	limitTwoDeletions: bounds the memory of the twoDeletions index; see
+//		deletions.cpp
+//	rankByEdits: chooses how showAlternatives ranks what it finds in the
+//		reducedWordTable
+//	removeWord: removes a word, with exactMembership only
+//	writeImage, and a second initializer: see image.cpp
 //
 //	All words are represented in Unicode.  Most routines use UCS; some also
 //	accept UTF8.  The dictionary files must be in UTF8.
 
 #include <string.h>
 #include <stdlib.h>
-#include <unistd.h>
 #include "uspell.h"
 #include "utf8convert.h"
 #include "uniprops.h"
 #include "transcribe.h"
-#include "lookup2.h"
+#include "rollhash.h"
+#include "editdistance.h"
+#include "wordhash.h"
+#include "image.h"
+#ifdef CODES_SSE2
+#include <emmintrin.h>
+#endif
 
-void uSpell::ignoreWord(const wide_t *string, const int length) {
-	int hashVersion;
-	unsigned int hashValue;
-	for (hashVersion = 1; hashVersion <= maxHashVersion; hashVersion++) {
-		hashValue = hash2(string, length, hashVersion) &
-			goodWordTableMask;
-		goodWordTable[hashValue >> 5] |= 1 << (hashValue & 0x1f);
+// Return the set of codes in the string, as one bit per code modulo 64.  The
+// alphabet gives the first 63 characters it meets different bits.
+static __uint64_t signature(const unsigned char *codes, const int length) {
+	__uint64_t answer = 0;
+	int index;
+	for (index = 0; index < length; index += 1) {
+		answer |= static_cast<__uint64_t>(1) << (codes[index] & 63);
 	}
-} // ignoreWord
+	return(answer);
+} // signature
 
-bool uSpell::inGoodWordTable(const wide_t *string, const int length) {
-	int hashVersion;
-	int hashValue;
-	int loc, offset;
-	for (hashVersion = 1; hashVersion <= maxHashVersion; hashVersion++) {
-		hashValue = hash2(string, length, hashVersion) &
-			goodWordTableMask;
-		loc = hashValue >> 5;
-		offset = 1 << (hashValue & 0x1f);
-		// fprintf(stdout, "hashvalue 0x%x at table[%d], bit 0x%x ... ", hashValue, loc, offset);
-		if (goodWordTable[loc] & offset) {
-			// fprintf(stdout, "found\n");
-		} else {
-			// fprintf(stdout, "not found\n");
-			return(false);
+// Return a lower bound on the wordDiff() of two reduced forms, from their
+// lengths and signatures.  The first pass of wordDiff() can match at most
+// length2 letters of the first form, and none whose signature bit is missing
+// from signature2; so too the second pass.
+static inline int diffBound(const int length1, const __uint64_t signature1,
+		const int length2, const __uint64_t signature2) {
+	int missing1, missing2;
+	missing1 = __builtin_popcountll(signature1 & ~signature2);
+	missing2 = __builtin_popcountll(signature2 & ~signature1);
+	if (length1 - length2 > missing1) missing1 = length1 - length2;
+	if (length2 - length1 > missing2) missing2 = length2 - length1;
+	return(missing1 + missing2);
+} // diffBound
+
+// Return a lower bound on the edit distance of two reduced forms, likewise.
+// Each edit inserts or omits at most one letter of either form, or replaces
+// one with another, so it makes up at most one of the letters either form
+// lacks, and changes the length by at most one.
+static inline int editBound(const int length1, const __uint64_t signature1,
+		const int length2, const __uint64_t signature2) {
+	int missing1, missing2;
+	missing1 = __builtin_popcountll(signature1 & ~signature2);
+	missing2 = __builtin_popcountll(signature2 & ~signature1);
+	if (missing2 > missing1) missing1 = missing2;
+	if (length1 - length2 > missing1) missing1 = length1 - length2;
+	if (length2 - length1 > missing1) missing1 = length2 - length1;
+	return(missing1);
+} // editBound
+
+// The alphabet gives each character of the reduced forms a dense code of one
+// byte, in the order the characters are first met, so the reduced forms take
+// a quarter of the room and compare a byte at a time.  Codes run from 1 to
+// escapeCode-1; every character past those, or met only in a probe, has
+// escapeCode, which wordDiff() must not take as a match.  Finding a code is
+// two steps: alphabetPages[c >> 8] picks a page of alphabetCodes, and the
+// page has the code at c & 255.  Page 0 has only zeroes.
+
+void uSpell::initAlphabet() {
+	alphabetSize = 1; // code 0 is not used
+	alphabet[0] = 0;
+	alphabetPages = reinterpret_cast<__uint16_t *>(
+		calloc(alphabetLimit >> 8, sizeof(alphabetPages[0])));
+	alphabetCodes = reinterpret_cast<unsigned char *>(calloc(256, 1));
+	if (alphabetPages == NULL || alphabetCodes == NULL) throw(noMem);
+	alphabetPageCount = 1;
+} // initAlphabet
+
+// Give c the next code, if there is one left.
+void uSpell::addToAlphabet(const wide_t c) {
+	if (c >= alphabetLimit || alphabetSize >= escapeCode) return;
+	if (alphabetPages[c >> 8] == 0) { // start a page for it
+		unsigned char *newCodes = reinterpret_cast<unsigned char *>(
+			realloc(alphabetCodes, (alphabetPageCount+1) * 256));
+		if (newCodes == NULL) throw(noMem);
+		alphabetCodes = newCodes;
+		memset(alphabetCodes + alphabetPageCount*256, 0, 256);
+		alphabetPages[c >> 8] = alphabetPageCount++;
+	}
+	alphabetCodes[(alphabetPages[c >> 8] << 8) | (c & 255)] = alphabetSize;
+	alphabet[alphabetSize++] = c;
+} // addToAlphabet
+
+inline unsigned char uSpell::codeOf(const wide_t c) {
+	if (c >= alphabetLimit) return(escapeCode);
+	unsigned char code = alphabetCodes[(alphabetPages[c >> 8] << 8) |
+		(c & 255)];
+	return(code ? code : escapeCode);
+} // codeOf
+
+// Place the codes of source[0..length-1] in dest.  If extend, characters
+// without codes get new ones while they last.  Returns true if any of the
+// codes is escapeCode.
+bool uSpell::encode(unsigned char *dest, const wide_t *source,
+		const int length, const bool extend) {
+	int index;
+	bool escaped = false;
+	for (index = 0; index < length; index += 1) {
+		dest[index] = codeOf(source[index]);
+		if (dest[index] == escapeCode && extend) {
+			addToAlphabet(source[index]);
+			dest[index] = codeOf(source[index]);
+		}
+		escaped |= dest[index] == escapeCode;
+	}
+	return(escaped);
+} // encode
+
+// The reducedWordTable is a Robin Hood hash table of slots, grouped into
+// buckets of one cache line each.  A key's home is the first slot of bucket
+// (hash & bucket mask).  Entries are kept in order of their homes, so all the
+// entries with one home, and therefore all the entries of one key, are
+// contiguous, starting at or soon after the home.  A slot holds the whole
+// hash of its key, which tells us its home (so we can grow the table) and
+// distinguishes it from other keys with the same home.  An entry's
+// displacement is how many slots it lies past its home.
+//
+// The table grows incrementally.  A new, larger table becomes the
+// reducedWordTable, and each insertion moves a few buckets' worth of entries
+// from the old one, in bucket order.  Until then, a key whose old home has not
+// been moved yet is looked up in both tables, old one first.  Moved entries
+// go in front of any entries of their key inserted since, so the entries of
+// a key are always visited in the order they were inserted.
+
+// How far the entry at position in table, of mask+1 slots, is from its home.
+inline int uSpell::displacementAt(const slot_t *table, const int mask,
+		const int position) {
+	return((position - (table[position].hash & (mask / bucketSlots)) *
+		bucketSlots) & mask);
+} // displacementAt
+
+// Tell whether the home of hashValue in the old table hasn't been moved yet.
+inline bool uSpell::unmigrated(const __uint32_t hashValue) {
+	return(oldReducedWordTable != NULL &&
+		static_cast<int>(hashValue & (oldReducedWordTableMask / bucketSlots))
+		>= migratedBuckets);
+} // unmigrated
+
+// Tell whether table, of mask+1 slots, already holds entry.
+bool uSpell::holdsReducedEntry(const slot_t *table, const int mask,
+		const slot_t entry) {
+	int position, displacement, slotDisplacement;
+	position = (entry.hash & (mask / bucketSlots)) * bucketSlots;
+	for (displacement = 0; table[position].wordId;
+			displacement += 1, position = (position + 1) & mask) {
+		slotDisplacement = displacementAt(table, mask, position);
+		if (slotDisplacement < displacement) break; // past our home's entries
+		if (slotDisplacement == displacement &&
+				table[position].hash == entry.hash &&
+				table[position].wordId == entry.wordId)
+			return(true);
+	}
+	return(false);
+} // holdsReducedEntry
+
+// Put entry into the reducedWordTable, after any entries with earlier homes
+// and after (or, if beforeKey, before) the entries of its own key, shifting
+// later entries down.  There must be an empty slot.
+void uSpell::placeReducedEntry(slot_t entry, const bool beforeKey) {
+	int position, displacement, slotDisplacement;
+	const int bucketMask = reducedWordTableMask / bucketSlots;
+	slot_t carried;
+	position = (entry.hash & bucketMask) * bucketSlots;
+	for (displacement = 0; reducedWordTable[position].wordId;
+			displacement += 1) {
+		slotDisplacement = displacementAt(reducedWordTable,
+			reducedWordTableMask, position);
+		if (slotDisplacement < displacement) break;
+			// this entry has a later home; entry belongs here
+		if (beforeKey && slotDisplacement == displacement &&
+			reducedWordTable[position].hash == entry.hash) break;
+		position = (position + 1) & reducedWordTableMask;
+	}
+	while (entry.wordId) { // place entry, carry the one it displaces
+		carried = reducedWordTable[position];
+		reducedWordTable[position] = entry;
+		entry = carried;
+		position = (position + 1) & reducedWordTableMask;
+	}
+} // placeReducedEntry
+
+// Make an empty reducedWordTable of length slots, a power of 2.  The
+// entries, if any, are not copied.
+void uSpell::allocateReducedWordTable(const int length) {
+	void *newTable;
+	if (posix_memalign(&newTable, bucketSlots*sizeof(slot_t),
+			length*sizeof(slot_t))) {
+		throw(noMem);
+	}
+	memset(newTable, 0, length*sizeof(slot_t));
+	reducedWordTable = reinterpret_cast<slot_t *>(newTable);
+	reducedWordTableLength = length;
+	reducedWordTableMask = length - 1;
+	reducedWordTableOwned = true;
+} // allocateReducedWordTable
+
+// Start moving the reducedWordTable to a new one of length slots, a power
+// of 2.
+void uSpell::startReducedMigration(const int length) {
+	if (oldReducedWordTable) { // finish the last one first
+		migrateReducedBuckets(oldReducedWordTableMask + 1);
+	}
+	oldReducedWordTable = reducedWordTable;
+	oldReducedWordTableMask = reducedWordTableMask;
+	oldReducedWordTableOwned = reducedWordTableOwned;
+	migratedBuckets = 0;
+	allocateReducedWordTable(length);
+} // startReducedMigration
+
+// Move the entries of up to count more buckets of the old table.
+void uSpell::migrateReducedBuckets(int count) {
+	int home, displacement, position;
+	const int bucketMask = oldReducedWordTableMask / bucketSlots;
+	for (; count > 0 && oldReducedWordTable; count -= 1) {
+		// find the end of the entries with this home
+		home = migratedBuckets * bucketSlots;
+		for (displacement = 0; ; displacement += 1) {
+			position = (home + displacement) & oldReducedWordTableMask;
+			if (!oldReducedWordTable[position].wordId ||
+					displacementAt(oldReducedWordTable, oldReducedWordTableMask,
+					position) < displacement)
+				break;
+		}
+		// move them last to first, each in front of its key's entries
+		while (displacement--) {
+			position = (home + displacement) & oldReducedWordTableMask;
+			if (displacementAt(oldReducedWordTable, oldReducedWordTableMask,
+					position) == displacement) {
+				placeReducedEntry(oldReducedWordTable[position], true);
+			}
+		}
+		migratedBuckets += 1;
+		if (migratedBuckets > bucketMask) { // done
+			if (oldReducedWordTableOwned) free(oldReducedWordTable);
+			oldReducedWordTable = NULL;
 		}
 	}
-	return(true); // found
-} // inGoodWordTable
-
-// We use quadratic rehashing to avoid mallocs for external chains.
-// We don't store the keys in the table, just a single fileOffset_t datum.
-
-int insertCount = 0;
-
-void uSpell::insertReducedWordTable(const wide_t *string, const int length,
-		const fileOffset_t aValue, const int fileNumber) {
-	int hashVal = hash2(string, length, 1) & reducedWordTableMask;
-	int probeDelta = 1;
-	int pathLength = 0;
-	while (reducedWordTable[hashVal]) {
-		if (reducedWordTable[hashVal] & offsetMask == aValue) return;
-			// duplicate
-		probeDelta = (probeDelta<<1) | 1;
-		hashVal = (hashVal + probeDelta) & reducedWordTableMask;
-		pathLength += 1;
-	}
-	reducedWordTable[hashVal] = aValue + (fileNumber << offsetBits);
-	insertCount += 1;
-	if (pathLength > 100) { // too long!
-		fprintf(stdout, "You need a bigger hash table\n");
-		exit(1);
-	}
-	// fprintf(stdout, "inserting %s=%d at location %d\n",
-	// 	makeUTF(string, length), aValue, hashVal);
+} // migrateReducedBuckets
+
+// Make sure the tables can take words more words, with at most entries more
+// entries in the reducedWordTable, without growing.  The estimate of entries
+// is usually high, so we size the reducedWordTable to hold them just below
+// the load at which it grows.
+void uSpell::reserveTables(const int words, const int entries) {
+	int length;
+	length = minTableLength;
+	while ((length / 8) * 7 < reducedWordCount + entries) length <<= 1;
+	if (reducedWordTable == NULL) {
+		allocateReducedWordTable(length);
+	} else if (length > reducedWordTableLength) {
+		startReducedMigration(length);
+	}
+	reserveGoodWords(words);
+} // reserveTables
+
+// Finish any migrations in progress.
+void uSpell::settleTables() {
+	if (oldReducedWordTable) migrateReducedBuckets(oldReducedWordTableMask + 1);
+	if (newGoodWordTable) migrateGoodWords(infinity);
+	if (oldExactWordTable) migrateExactBuckets(oldExactWordTableMask + 1);
+} // settleTables
+
+// Insert wordId under the key whose rollHash() is hashValue.
+void uSpell::insertReducedWordTable(const __uint32_t hashValue,
+		const wordId_t wordId) {
+	slot_t entry;
+	entry.hash = hashValue;
+	entry.wordId = wordId;
+	if (unmigrated(entry.hash) && holdsReducedEntry(oldReducedWordTable,
+			oldReducedWordTableMask, entry)) {
+		return; // duplicate
+	}
+	if (holdsReducedEntry(reducedWordTable, reducedWordTableMask, entry)) {
+		return; // duplicate
+	}
+	if (!reducedWordTableOwned) { // it's in the image; move it out
+		startReducedMigration(reducedWordTableLength);
+	}
+	placeReducedEntry(entry, false);
+	reducedWordCount += 1;
+	if (oldReducedWordTable) migrateReducedBuckets(reducedMigrationStep);
+	// Grow on load alone.  Long displacements come from runs of one key,
+	// which stay together in any table, so growing wouldn't shorten them.
+	if (reducedWordCount * 8 > reducedWordTableLength * 7) {
+		startReducedMigration(2 * reducedWordTableLength);
+	}
 } // insertReducedWordTable
 
-void uSpell::initSuggestions() {
-	suggestions[0].goodness = infinity; // pseudo-data
-	suggestionCount = 1;
+// The suggestions are a heap of the best limit words found so far, worst at
+// the root.  Of equally good words, the one found first is better, so the
+// heaviest heuristics, tried first, win ties.  heldIds is a hash set of the
+// words in the heap, so a word found again is recognized at once; a word that
+// was dropped from the heap, or never got in, could not get in now either.
+
+void uSpell::initSuggestions(const int limit, const int worst) {
+	suggestionLimit = limit < BUFLEN ? limit : BUFLEN;
+	suggestionWorst = worst;
+	suggestionCount = 0;
+	suggestionOrder = 0;
+	memset(heldIds, 0, sizeof(heldIds));
 } // initSuggestions
 
-void uSpell::addSuggestion(const fileOffset_t fileOffset, const int goodness) {
+// Return true if suggestion1 is worse than suggestion2.
+static inline bool worseSuggestion(const int goodness1, const int order1,
+		const int goodness2, const int order2) {
+	return(goodness1 > goodness2 ||
+		(goodness1 == goodness2 && order1 > order2));
+} // worseSuggestion
+
+// Return the largest goodness that can still join the suggestions, or -1 if
+// none can.
+int uSpell::acceptableGoodness() {
+	if (suggestionCount < suggestionLimit) return(suggestionWorst);
+	if (suggestionLimit == 0) return(-1);
+	return(suggestions[0].goodness - 1); // ties lose to the root
+} // acceptableGoodness
+
+// Return where wordId is, or should go, in heldIds.
+int uSpell::heldSlot(const wordId_t wordId) {
+	int slot = (wordId * 0x9e3779b1) >> (32 - heldBits);
+	while (heldIds[slot] && heldIds[slot] != wordId) {
+		slot = (slot + 1) & (heldRoom - 1);
+	}
+	return(slot);
+} // heldSlot
+
+// Remove wordId from heldIds, moving later entries of its run back so that
+// none is cut off from its home.
+void uSpell::dropHeld(const wordId_t wordId) {
+	int hole, slot, home;
+	hole = heldSlot(wordId);
+	heldIds[hole] = 0;
+	for (slot = (hole + 1) & (heldRoom - 1); heldIds[slot];
+			slot = (slot + 1) & (heldRoom - 1)) {
+		home = (heldIds[slot] * 0x9e3779b1) >> (32 - heldBits);
+		if (((slot - home) & (heldRoom - 1)) >=
+				((slot - hole) & (heldRoom - 1))) {
+			heldIds[hole] = heldIds[slot];
+			heldIds[slot] = 0;
+			hole = slot;
+		}
+	}
+} // dropHeld
+
+// Put entry in the heap of the first count suggestions, at index or below.
+void uSpell::siftSuggestion(int index, const suggestion_t entry,
+		const int count) {
+	int child;
+	while ((child = 2*index + 1) < count) {
+		if (child + 1 < count && worseSuggestion(
+				suggestions[child+1].goodness, suggestions[child+1].order,
+				suggestions[child].goodness, suggestions[child].order)) {
+			child += 1;
+		}
+		if (!worseSuggestion(suggestions[child].goodness,
+				suggestions[child].order, entry.goodness, entry.order)) {
+			break;
+		}
+		suggestions[index] = suggestions[child];
+		index = child;
+	}
+	suggestions[index] = entry;
+} // siftSuggestion
+
+void uSpell::addSuggestion(const wordId_t wordId, const int goodness) {
 	int index;
-	suggestion_t tmpSuggestion, nextSuggestion;
-	if (goodness > maxDistance) return; // not good enough
-	if (suggestionCount >= BUFLEN) { // should toss the bottom one
-		fprintf(stderr, "Out of room for suggestions\n");
-		exit(1);
-	}
-	// skip better and equally good suggestions; we use better heuristics first
-	for (index = 0; goodness >= suggestions[index].goodness; index++){
-		if (suggestions[index].fileOffset == fileOffset) { // duplicate
-			if (suggestions[index].goodness > goodness)
-				suggestions[index].goodness = goodness; // take better one
-			return;
-		} // duplicate
-	}
-	// fprintf(stdout, "adding suggestion %d (%d)\n", fileOffset, goodness);
-	// put this suggestion in, saving what it will overwrite
-	tmpSuggestion = suggestions[index];
-	suggestions[index].fileOffset = fileOffset;
-	suggestions[index].goodness = goodness;
-	// move suggestions[index .. suggestionCount-1] over.
-	for (index += 1; index <= suggestionCount; index++) {
-		nextSuggestion = suggestions[index];
-		suggestions[index] = tmpSuggestion;
-		tmpSuggestion = nextSuggestion;
-	}
-	suggestionCount += 1;
+	suggestion_t entry;
+	if (goodness > acceptableGoodness()) return; // not good enough
+	if (heldIds[heldSlot(wordId)]) return; // duplicate, just as good
+	entry.wordId = wordId;
+	entry.goodness = goodness;
+	entry.order = suggestionOrder++;
+	// fprintf(stdout, "adding suggestion %d (%d)\n", wordId, goodness);
+	if (suggestionCount < suggestionLimit) { // sift up from a new leaf
+		index = suggestionCount++;
+		while (index > 0 && worseSuggestion(entry.goodness, entry.order,
+				suggestions[(index-1)/2].goodness,
+				suggestions[(index-1)/2].order)) {
+			suggestions[index] = suggestions[(index-1)/2];
+			index = (index-1)/2;
+		}
+		suggestions[index] = entry;
+	} else { // it replaces the worst, at the root
+		dropHeld(suggestions[0].wordId);
+		siftSuggestion(0, entry, suggestionCount);
+	}
+	heldIds[heldSlot(wordId)] = wordId;
 } // addSuggestion
 
-// add all the words in the reducedWordTable that match the given probe to
-// suggestions[].  The probe should already be reduced.
-void uSpell::addMatches(const wide_t *probe, const int probeLength,
-		const wide_t *target, const int targetLength) {
-	int hashVal;
-	int probeDelta = 1;
-	fileOffset_t index;
-	hashVal = hash2(probe, probeLength, 1) & reducedWordTableMask;
-	while ((index = reducedWordTable[hashVal])) {
-		// we never store a 0, because the first file is #1, not #0.
-		int fileNumber = index >> offsetBits;
-		fileOffset_t offset = index & offsetMask;
-		utf8_t wordBuf[BUFLEN]; int wordLen;
-		wide_t reduceBuf[BUFLEN]; int reduceLen;
-		wide_t bigWordBuf[BUFLEN];
-		fseek(wordFiles[fileNumber], offset, SEEK_SET);
-		fgets(reinterpret_cast<char *>(wordBuf), BUFLEN, wordFiles[fileNumber]);
-		wordBuf[strlen(reinterpret_cast<char *>(wordBuf))-1] = 0; // chomp \n
-		wordLen = utf8_wide(bigWordBuf, wordBuf, BUFLEN);
-		reduce(reduceBuf, &reduceLen, bigWordBuf, wordLen, myTranscribe);
-		addSuggestion(index, wordDiff(reduceBuf, reduceLen, target,
-			targetLength));
-		// fprintf(stdout, "match %s", makeUTF(reduceBuf, reduceLen));
-		// fprintf(stdout, "/%s(%d) ", makeUTF(target, targetLength),
-		// 	wordDiff(reduceBuf, reduceLen, target, targetLength));
-		probeDelta = (probeDelta<<1) | 1;
-		hashVal = (hashVal + probeDelta) & reducedWordTableMask;
+// Sort the suggestions best first; they are no longer a heap.
+void uSpell::sortSuggestions() {
+	int end;
+	suggestion_t worst;
+	for (end = suggestionCount - 1; end > 0; end -= 1) {
+		worst = suggestions[0];
+		siftSuggestion(0, suggestions[end], end);
+		suggestions[end] = worst;
+	}
+} // sortSuggestions
+
+// add all the words in the reducedWordTable that match the probe whose
+// rollHash() is hashValue to suggestions[].  The probe should already be
+// reduced; target is the reduced form of the misspelling.
+void uSpell::addMatches(const __uint32_t hashValue, const target_t *target) {
+	if (unmigrated(hashValue)) { // older entries of the key are here
+		addTableMatches(oldReducedWordTable, oldReducedWordTableMask,
+			hashValue, target);
 	}
+	addTableMatches(reducedWordTable, reducedWordTableMask, hashValue, target);
 } // addMatches
 
+// addMatches() for one table, of mask+1 slots.  The words that survive the
+// filters are scored in batches of up to candidateRoom, in the order of the
+// chain.
+void uSpell::addTableMatches(const slot_t *table, const int mask,
+		const __uint32_t hashValue, const target_t *target) {
+	int position, displacement, slotDisplacement, candidateCount, bound;
+	wordId_t candidates[candidateRoom];
+	if (acceptableGoodness() < 0) return; // no word can get in
+	position = (hashValue & (mask / bucketSlots)) * bucketSlots;
+	candidateCount = 0;
+	for (displacement = 0; table[position].wordId;
+			displacement += 1, position = (position+1) & mask) {
+		wordId_t wordId = table[position].wordId;
+		slotDisplacement = displacementAt(table, mask, position);
+		if (slotDisplacement < displacement) break; // past our home's entries
+		if (slotDisplacement > displacement) continue; // an earlier home
+		if (table[position].hash != hashValue) continue;
+			// another key with our home
+		// Skip words that can't be close enough, from the columns alone.
+		bound = editRanking ?
+			editBound(reducedLengths[wordId], signatures[wordId],
+				target->length, target->signature) :
+			diffBound(reducedLengths[wordId], signatures[wordId],
+				target->length, target->signature);
+		if (bound > acceptableGoodness()) {
+			boundedCandidates += 1;
+			continue;
+		}
+		if (wordOffsets[wordId] == removedWord) continue;
+		scoredCandidates += 1;
+		candidates[candidateCount++] = wordId;
+		if (candidateCount < candidateRoom) continue;
+		addCandidates(target, candidates, candidateCount);
+		candidateCount = 0;
+	}
+	if (candidateCount) addCandidates(target, candidates, candidateCount);
+} // addTableMatches
+
+// Score the count words in wordIds[] and add them to suggestions[], in order.
+void uSpell::addCandidates(const target_t *target, const wordId_t *wordIds,
+		const int count) {
+	int scores[candidateRoom], index;
+	if (editRanking) {
+		editDiffs(target, wordIds, count, scores);
+	} else {
+		wordDiffs(target, wordIds, count, scores, acceptableGoodness());
+	}
+	for (index = 0; index < count; index += 1) {
+		addSuggestion(wordIds[index], scores[index]);
+	}
+} // addCandidates
+
 // probe is not yet reduced; it is misspelled.  Print all the words that it
 // might be.
 int uSpell::showAlternatives(const wide_t *probe, const int length,
 	utf8_t **list, const int maxAlternatives) {
 	wide_t reduceBuf[BUFLEN];
-	int reduceLength;
+	__uint32_t reduceHash, hashes[BUFLEN], interchanges[BUFLEN];
+	target_t target;
+	int reduceLength, index;
+	bool useTrie, useDeletions;
 	// fprintf(stdout, "checking %s\n", makeUTF(probe, length));
-	if (inGoodWordTable(probe, length)) {
+	if (isSpelledRight(probe, length)) {
 		// fprintf(stdout, "spelled correctly\n");
 		return(0);
 	}
-	initSuggestions();
-	reduce(reduceBuf, &reduceLength, probe, length, myTranscribe);
+	if (maxAlternatives <= 0) return(0);
+	reduceProbe(reduceBuf, &reduceLength, probe, length, myTranscribe);
 	// fprintf(stdout, "(reduction %s) ", makeUTF(reduceBuf, reduceLength));
-	addMatches(reduceBuf, reduceLength, reduceBuf, reduceLength);
-	{ // omit seriatim each letter of the reduction.
-		wide_t tmp[BUFLEN];
-		wide_t save1, save2;
-		int index;
-		memcpy(tmp, reduceBuf, sizeof(wide_t)*reduceLength);
-		save2 = *tmp;
-		for (index = 0; index < reduceLength; index++) { // omit letter at index
-			save1 = tmp[index];
-			tmp[index] = save2;
-			save2 = save1;
-			// fprintf(stdout, "(omission %s) ", makeUTF(tmp+1, reduceLength-1));
-			addMatches(tmp+1, reduceLength-1, reduceBuf, reduceLength);
+	target.characters = reduceBuf;
+	target.length = reduceLength;
+	target.escaped = encode(target.codes, reduceBuf, reduceLength, false);
+	memset(target.window, 0, sizeof(target.window));
+	memcpy(target.window + spread, target.codes,
+		reduceLength < maskedLength ? reduceLength : maskedLength);
+	target.signature = signature(target.codes, reduceLength);
+	// Choose the engine, then the worst goodness it may suggest: the trie
+	// and deletion engines score differently from the hash engine they fall
+	// back on.
+	useTrie = trieDistance && reduceLength <= maxTrieLength;
+	useDeletions = !useTrie && (theFlags & twoDeletions) &&
+		deletionsCover(reduceLength);
+	initSuggestions(maxAlternatives, useTrie ?
+		trieDistance * trieTieScale + trieTieScale - 1 :
+		useDeletions ? maxEdits * trieTieScale + trieTieScale - 1 :
+		editRanking ? maxEdits : maxDistance);
+	if (useTrie || useDeletions || editRanking) {
+		editMasks(target.masks, target.codes, reduceLength);
+	}
+	if (useTrie) {
+		trieAlternatives(&target);
+	} else if (useDeletions) {
+		deletionAlternatives(&target);
+	} else {
+		reduceHash = variantHashes(reduceBuf, reduceLength, hashBackend,
+			hashes, interchanges);
+		addMatches(reduceHash, &target);
+		// omit seriatim each letter of the reduction, once per run.
+		for (index = 0; index < reduceLength; index++) {
+			if (index && reduceBuf[index] == reduceBuf[index-1]) continue;
+			addMatches(hashes[index], &target);
 		}
-	} // omit seriatim
-	{ // interchange seriatim each letter of the reduction.
-		int index;
-		wide_t tmp[BUFLEN];
-		memcpy(tmp, reduceBuf, sizeof(wide_t)*reduceLength);
+		// interchange seriatim each letter of the reduction.
 		for (index = 1; index < reduceLength; index++) {
-			wide_t saveChar;
-			saveChar = tmp[index];
-			tmp[index] = tmp[index-1];
-			tmp[index-1] = saveChar;
-			// fprintf(stdout, "(interch %s) ", makeUTF(tmp, reduceLength));
-			addMatches(tmp, reduceLength, reduceBuf, reduceLength);
-			tmp[index-1] = tmp[index];
-			tmp[index] = saveChar;
+			addMatches(interchanges[index-1], &target);
 		}
-	} // interchange seriatim
+	}
 	// fprintf(stdout, "\n");
-	int index;
-	for (index = 0; index < suggestionCount-1 /* last is pseudo */; index++) {
-		utf8_t buf[BUFLEN];
-		fileOffset_t offset;
-		int fileNumber;
-		if (index >= maxAlternatives) break;
-		offset = suggestions[index].fileOffset & offsetMask;
-		fileNumber = suggestions[index].fileOffset >> offsetBits;
-		fseek(wordFiles[fileNumber], offset, SEEK_SET);
-		fgets(reinterpret_cast<char *>(buf), BUFLEN, wordFiles[fileNumber]);
-		buf[strlen(reinterpret_cast<char *>(buf))-1] = 0; // chomp \n
+	sortSuggestions();
+	for (index = 0; index < suggestionCount; index++) {
+		wordId_t wordId;
+		wordId = suggestions[index].wordId;
 		list[index] = reinterpret_cast<utf8_t *>(
-			malloc(strlen(reinterpret_cast<char *>(buf))+1));
-		strcpy(reinterpret_cast<char *>((list[index])),
-			reinterpret_cast<char *>(buf));
+			malloc(wordLengths[wordId]+1));
+		memcpy(list[index], wordAt(wordId), wordLengths[wordId]);
+		list[index][wordLengths[wordId]] = 0;
 	}
 	return(index);
 } // showAlternatives
 
-void inline uSpell::acceptGoodWord(const utf8_t *buf, int wordPosition,
-		int fileNumber) {
-	wide_t bigBuf1[BUFLEN], bigBuf2[BUFLEN], reduceBuf[BUFLEN];
-	int bigLength, reduceLength;
-	bigLength = utf8_wide(bigBuf1, buf, BUFLEN);
-	if (theFlags & expandPrecomposed) {
-		unPrecompose(bigBuf2, &bigLength, bigBuf1, bigLength);
-		if (inGoodWordTable(bigBuf2, bigLength))
-			return; // no need for duplicate
-		ignoreWord(bigBuf2, bigLength); // actually a good word
-		reduce(reduceBuf, &reduceLength, bigBuf2, bigLength, myTranscribe);
-	} else { // don't expand precomposed
-		if (inGoodWordTable(bigBuf1, bigLength))
-			return; // no need for duplicate
-		ignoreWord(bigBuf1, bigLength); // actually a good word
-		reduce(reduceBuf, &reduceLength, bigBuf1, bigLength, myTranscribe);
+int uSpell::showAlternatives(const utf8_t *probe, const size_t length,
+	utf8_t **list, const int maxAlternatives) {
+	wide_t bigBuf[BUFLEN];
+	int bigLength;
+	if (isSpelledRight(probe, length)) return(0);
+	bigLength = utf8_wide(bigBuf, probe, length, BUFLEN);
+	return(showAlternatives(bigBuf, bigLength, list, maxAlternatives));
+} // showAlternatives
+
+void uSpell::rankByEdits(const bool byEdits) {
+	editRanking = byEdits;
+} // rankByEdits
+
+void uSpell::reportStatistics(FILE *outFile) {
+	static const int histogramLength = 8;
+	int histogram[histogramLength+1]; // lookups by cache lines touched
+	int bucket, position, displacement, slotDisplacement, lines;
+	int homeEntries, farthest = 0;
+	long totalDisplacement = 0;
+	int bucketMask;
+	settleTables();
+	bucketMask = reducedWordTableMask / bucketSlots;
+	memset(histogram, 0, sizeof(histogram));
+	for (bucket = 0; bucket <= bucketMask; bucket += 1) {
+		// a lookup of a key at home bucket reads from there to the first
+		// entry with a later home, or an empty slot.
+		position = bucket * bucketSlots;
+		homeEntries = 0;
+		for (displacement = 0; reducedWordTable[position].wordId;
+				displacement += 1,
+				position = (position + 1) & reducedWordTableMask) {
+			slotDisplacement = (position -
+				(reducedWordTable[position].hash & bucketMask) * bucketSlots) &
+				reducedWordTableMask;
+			if (slotDisplacement < displacement) break;
+			if (slotDisplacement > displacement) continue;
+			homeEntries += 1;
+			totalDisplacement += displacement;
+			if (displacement > farthest) farthest = displacement;
+		}
+		lines = displacement / bucketSlots + 1;
+		if (lines > histogramLength) lines = histogramLength;
+		histogram[lines] += homeEntries;
+	}
+	fprintf(outFile, "words: %d\n", wordCount - 1);
+	if (theFlags & exactMembership) {
+		fprintf(outFile, "exact table: %d slots, %d words, load %.3f\n",
+			exactWordTableMask + 1, exactWordCount,
+			static_cast<double>(exactWordCount) / (exactWordTableMask + 1));
+	} else {
+		fprintf(outFile, "good table: %d bits, %d words, %.1f bits/word, "
+			"%d probes, false positives %.2g\n",
+			goodWordTableMask + 1, goodWordCount, goodWordCount ?
+			static_cast<double>(goodWordTableMask + 1) / goodWordCount : 0.0,
+			goodProbes, falsePositiveRate());
+	}
+	fprintf(outFile, "reduced table: %d slots in %d buckets, %d entries, "
+		"load %.3f, %.1f entries/word, %lu bytes\n", reducedWordTableLength,
+		bucketMask + 1, reducedWordCount,
+		static_cast<double>(reducedWordCount) / reducedWordTableLength,
+		wordCount > 1 ?
+			static_cast<double>(reducedWordCount) / (wordCount - 1) : 0.0,
+		static_cast<unsigned long>(reducedWordTableLength) *
+			sizeof(reducedWordTable[0]));
+	fprintf(outFile, "displacement: average %.2f, maximum %d\n",
+		reducedWordCount ?
+			static_cast<double>(totalDisplacement) / reducedWordCount : 0.0,
+		farthest);
+	fprintf(outFile, "cache lines per lookup, by entry:");
+	for (lines = 1; lines <= histogramLength; lines += 1) {
+		fprintf(outFile, " %d%s:%d", lines,
+			lines == histogramLength ? "+" : "", histogram[lines]);
+	}
+	fprintf(outFile, "\n");
+	fprintf(outFile, "suggestion candidates: %lu scored, %lu rejected by "
+		"bounds\n", scoredCandidates, boundedCandidates);
+	fprintf(outFile, "alphabet: %d codes in %d pages; reduced forms: %u "
+		"bytes\n", alphabetSize - 1, alphabetPageCount - 1, reducedBlobLength);
+	if (trieNodes != NULL) {
+		fprintf(outFile, "trie: %d nodes, %lu bytes, %.1f nodes visited per "
+			"lookup\n", trieNodeCount, static_cast<unsigned long>(
+			trieNodeRoom * sizeof(trieNodes[0]) +
+			trieNextRoom * sizeof(trieNextWords[0])), trieLookups ?
+			static_cast<double>(trieVisits) / trieLookups : 0.0);
+	}
+	if (deletionBuckets != NULL) {
+		fprintf(outFile, "deletion index: %u entries in %d buckets, %lu "
+			"bytes (limit %lu), reduced forms of up to %d codes, %u words "
+			"added since\n", deletionCount, deletionBucketMask + 1,
+			static_cast<unsigned long>(deletionCount *
+			(sizeof(deletionChecks[0]) + sizeof(deletionIds[0])) +
+			(deletionBucketMask + 2) * sizeof(deletionBuckets[0])),
+			static_cast<unsigned long>(deletionLimit), deletionLength,
+			wordCount - deletionIndexed);
+	}
+	myTranscribe->reportStatistics(outFile);
+} // reportStatistics
+
+// Return the word with the given id.  It is not null-terminated; its length
+// is wordLengths[wordId].
+const utf8_t *uSpell::wordAt(const wordId_t wordId) {
+	fileOffset_t wordOffset = wordOffsets[wordId];
+	return(wordFiles[wordOffset >> offsetBits].text +
+		(wordOffset & offsetMask));
+} // wordAt
+
+// Make room for newRoom elements in a column that now holds count of them.
+// A column we don't own is in the image, so we copy it out.
+template <class element_t> static void growColumn(element_t **column,
+		const size_t count, const size_t newRoom, const bool owned) {
+	element_t *newColumn;
+	if (owned) {
+		newColumn = reinterpret_cast<element_t *>(
+			realloc(*column, newRoom*sizeof(element_t)));
+	} else {
+		newColumn = reinterpret_cast<element_t *>(
+			malloc(newRoom*sizeof(element_t)));
+		if (newColumn && count) memcpy(newColumn, *column,
+			count*sizeof(element_t));
+	}
+	if (newColumn == NULL) throw(uSpell::noMem);
+	*column = newColumn;
+} // growColumn
+
+// Give the word a new id and fill in its columns.
+uSpell::wordId_t uSpell::newWord(const fileOffset_t wordOffset,
+		const int wordLength, const wide_t *reduced, const int reducedLength) {
+	bool owned;
+	if (wordCount >= wordRoom) { // grow the columns
+		wordId_t newRoom = wordCount < 512 ? 1024 : 2*wordCount;
+		owned = wordRoom || wordOffsets == NULL;
+		growColumn(&wordOffsets, wordCount, newRoom, owned);
+		growColumn(&wordLengths, wordCount, newRoom, owned);
+		growColumn(&reducedStarts, wordCount, newRoom, owned);
+		growColumn(&reducedLengths, wordCount, newRoom, owned);
+		growColumn(&signatures, wordCount, newRoom, owned);
+		wordRoom = newRoom;
+	}
+	if (reducedBlobLength + reducedLength > reducedBlobRoom) { // grow the blob
+		size_t newRoom = reducedBlobRoom ? 2*reducedBlobRoom : 16384;
+		while (newRoom < reducedBlobLength + reducedLength) newRoom *= 2;
+		growColumn(&reducedBlob, reducedBlobLength, newRoom,
+			reducedBlobRoom || reducedBlob == NULL);
+		reducedBlobRoom = newRoom;
 	}
+	encode(reducedBlob + reducedBlobLength, reduced, reducedLength, true);
+	wordOffsets[wordCount] = wordOffset;
+	wordLengths[wordCount] = wordLength;
+	reducedStarts[wordCount] = reducedBlobLength;
+	reducedLengths[wordCount] = reducedLength;
+	signatures[wordCount] = signature(reducedBlob + reducedBlobLength,
+		reducedLength);
+	reducedBlobLength += reducedLength;
+	if (trieNodes != NULL) insertTrie(wordCount);
+	return(wordCount++);
+} // newWord
+
+void inline uSpell::acceptGoodWord(const utf8_t *buf, int bufLength,
+		int wordPosition, int fileNumber) {
+	wide_t bigBuf[BUFLEN], reduceBuf[BUFLEN];
+	utf8_t keyBuf[keyRoom+1];
+	const utf8_t *key; // the word as the goodWordTable has it
+	__uint32_t hashes[BUFLEN];
+	int keyLength = bufLength, bigLength, reduceLength, index;
+	wordId_t wordId;
+	key = wordKey(buf, &keyLength, keyBuf);
+	if (inGoodWordTable(key, keyLength))
+		return; // no need for duplicate
+	bigLength = utf8_wide(bigBuf, buf, bufLength, BUFLEN);
+	reduceWord(reduceBuf, &reduceLength, bigBuf, bigLength, myTranscribe);
 	// fprintf(stdout, "for reduced form [%s]",
-	// 		makeUTF(bigBuf2, bigLength));
+	// 		makeUTF(bigBuf, bigLength));
 	//	fprintf(stdout, "->[%s]\n", makeUTF(reduceBuf, reduceLength));
-	insertReducedWordTable(reduceBuf, reduceLength, wordPosition,
-		fileNumber);
-	{ // omit seriatim each letter of the reduction.
-		wide_t tmp[BUFLEN];
-		wide_t save1, save2;
-		int index;
-		memcpy(tmp, reduceBuf, sizeof(wide_t)*reduceLength);
-		save2 = *tmp;
-		for (index = 0; index < reduceLength; index++) {
-			// omit letter at index
-			save1 = tmp[index];
-			tmp[index] = save2;
-			save2 = save1;
-			insertReducedWordTable(tmp+1, reduceLength-1, wordPosition,
-				fileNumber);
-		}
-	} // omit seriatim
+	wordId = newWord(wordPosition + (fileNumber << offsetBits), bufLength,
+		reduceBuf, reduceLength);
+	addGoodWord(key, keyLength, wordId);
+	insertReducedWordTable(variantHashes(reduceBuf, reduceLength, hashBackend,
+		hashes, NULL), wordId);
+	// omit seriatim each letter of the reduction.  Omitting any letter of a
+	// run of equal letters gives the same form, which needs only one entry.
+	for (index = 0; index < reduceLength; index++) {
+		if (index && reduceBuf[index] == reduceBuf[index-1]) continue;
+		insertReducedWordTable(hashes[index], wordId);
+	}
 } // acceptGoodWord
 
 void uSpell::acceptWord(const utf8_t *string) {
-	int wordPosition;
-	if (wordFiles[NUMDICTFILES] == NULL) { // first time; create the file
-		const char *origTemplate = "/tmp/uspell.XXXXXX";
-		char fileName[BUFLEN];
-		strncpy(fileName, origTemplate, strlen(origTemplate)+1);
-		int fd = mkstemp(fileName);
-		// fprintf(stdout, "Temp file name from template %s is %s\n",
-		// 	origTemplate, fileName);
-		wordFiles[NUMDICTFILES] = fdopen(fd, "w+");
-		if (wordFiles[NUMDICTFILES] == NULL) throw(fileOpen);
-		unlink(fileName);  // a very temp file; open only so long as we last
-		wordPosition = 0;
-	} else {
-		fseek(wordFiles[NUMDICTFILES], 0L, SEEK_END);
-		wordPosition = ftell(wordFiles[NUMDICTFILES]);
+	wordFile_t *arena = &wordFiles[NUMDICTFILES];
+	int length = strlen(reinterpret_cast<const char *>(string));
+	int wordPosition = arena->length;
+	if (arena->length + length + 1 > arena->room) { // grow the arena
+		size_t newRoom = arena->room ? 2*arena->room : 4096;
+		while (newRoom < arena->length + length + 1) newRoom *= 2;
+		utf8_t *newText = reinterpret_cast<utf8_t *>(
+			realloc(arena->text, newRoom));
+		if (newText == NULL) throw(noMem);
+		arena->text = newText;
+		arena->room = newRoom;
 	}
-	fwrite(string, 1, strlen(reinterpret_cast<const char *>(string)),
-		wordFiles[NUMDICTFILES]);
-	fwrite("\n", 1, 2, wordFiles[NUMDICTFILES]);
-	acceptGoodWord(string, wordPosition, NUMDICTFILES);
+	memcpy(arena->text + arena->length, string, length);
+	arena->text[arena->length + length] = '\n';
+	arena->length += length + 1;
+	acceptGoodWord(string, length, wordPosition, NUMDICTFILES);
 } // acceptWord
 
+// Count the words (nonempty lines) and the characters in them.
+static void countWords(const utf8_t *text, const size_t length, int *words,
+		int *characters) {
+	size_t index;
+	bool inWord = false;
+	*words = *characters = 0;
+	for (index = 0; index < length; index += 1) {
+		if (text[index] == '\n') {
+			inWord = false;
+		} else if ((text[index] & 0xc0) != 0x80) { // not a continuation byte
+			*characters += 1;
+			if (!inWord) *words += 1;
+			inWord = true;
+		}
+	}
+} // countWords
+
 bool uSpell::assimilateFile(const char *wordFileName) {
-	int wordCount;
-	int wordPosition;
-	FILE *wordFile = fopen(wordFileName, "r");
-	utf8_t buf[BUFLEN];
-	if (wordFile == NULL) return(0);
+	wordFile_t *theFile;
+	const utf8_t *word, *end, *text;
+	int words, characters;
+	if (fileNumber + 1 >= NUMDICTFILES) return(false); // too many
+	theFile = &wordFiles[fileNumber + 1];
+	if (fileNumber == 0) { // the main dictionary
+		theFile->text = reinterpret_cast<utf8_t *>(
+			mapFile(wordFileName, &theFile->length));
+		if (theFile->text == NULL) return(false);
+		theFile->mapped = true;
+		theFile->room = 0;
+	} else { // a personal dictionary may change under a mapping; copy it
+		theFile->text = reinterpret_cast<utf8_t *>(
+			readFile(wordFileName, &theFile->length));
+		if (theFile->text == NULL) return(false);
+		theFile->mapped = false;
+		theFile->room = theFile->length + 1;
+	}
 	// fprintf(stdout, "assimilating file\n");
 	fileNumber += 1;
-	wordFiles[fileNumber] = wordFile;
-	if (fileNumber >= NUMDICTFILES) return(false);
+	// size the tables for the words and their variants: each word has its
+	// reduced form and one variant per character.
+	text = theFile->text;
+	countWords(text, theFile->length, &words, &characters);
+	reserveTables(words, characters + words);
 	// populate the hash table
-	if (fseek(wordFile, 0L, SEEK_SET)) { // make sure at start
-		return(false); // can't fseek
-	}
-	wordPosition = 0;
-	for (wordCount = 0;
-			fgets(reinterpret_cast<char *>(buf), BUFLEN, wordFile);
-			wordCount += 1) {
-		if (!strlen(reinterpret_cast<char *>(buf))) break;
-		buf[strlen(reinterpret_cast<char *>(buf))-1] = 0; // chomp \n
-		acceptGoodWord(buf, wordPosition, fileNumber);
-		wordPosition = ftell(wordFile);
+	for (word = text; word < text + theFile->length; word = end + 1) {
+		end = reinterpret_cast<const utf8_t *>(
+			memchr(word, '\n', text + theFile->length - word));
+		if (end == NULL) end = text + theFile->length; // no final newline
+		if (end == word) continue; // empty line
+		acceptGoodWord(word, end - word, word - text, fileNumber);
 	} // one word
 	// fprintf(stdout, "Added file %d.  Table density: %d/%d entries (%d%%)\n",
 	// 	fileNumber, insertCount, reducedWordTableLength,
@@ -309,80 +828,112 @@ bool uSpell::assimilateFile(const char *wordFileName) {
 
 uSpell::uSpell(const char *dictFile, const char *transcriptionFile,
 		const char flags) {
-	unsigned int tmpLength;
+	FILE *wordFile;
 	theFlags = flags;
+	hashBackend = flags & multiplyHash ? multiplyBackend : lookup2Backend;
+	image = NULL; // we build the tables ourselves
+	transcriptionHash = fileHash(transcriptionFile);
 	wordFile = fopen(dictFile, "r");
 	if (wordFile == NULL) {
 		throw(noSuchFile);
 	}
+	fclose(wordFile);
 	// fprintf(stdout, "starting to assimilate\n");
 	myTranscribe = new transcriber(transcriptionFile);
-	fseek(wordFile, 0, SEEK_END);
-	tmpLength = ftell(wordFile);
-	fclose(wordFile);
-	reducedWordTableLength = 1;
-	while (tmpLength) {
-		reducedWordTableLength <<= 1;
-		tmpLength >>= 1;
-	}
-	reducedWordTableMask = reducedWordTableLength - 1;
-	fprintf(stdout, "Table length: %d entries\n", reducedWordTableLength);
-	reducedWordTable = reinterpret_cast<hashTable>(
-		calloc(sizeof(reducedWordTable[0]), reducedWordTableLength));
-	if (reducedWordTable == NULL) {
-		throw(noMem);
-	}
-	// good word table has same effective size, but it's a bit table
-	goodWordTableLength = reducedWordTableLength >> 5;
-	goodWordTableMask = reducedWordTableMask;
-	goodWordTable = reinterpret_cast<hashTable>(
-		calloc(sizeof(goodWordTable[0]), goodWordTableLength));
-	if (goodWordTable == NULL) {
-		throw(noMem);
-	}
-	// initialize all wordfiles
+	reduceWord = reducerFor(theFlags & expandPrecomposed,
+		myTranscribe->hasRules());
+	reduceProbe = reducerFor(false, myTranscribe->hasRules());
+	// assimilateFile() sizes the tables from the words it finds
+	reducedWordTable = oldReducedWordTable = NULL;
+	reducedWordTableLength = reducedWordTableMask = reducedWordCount = 0;
+	goodWordTable = newGoodWordTable = NULL;
+	goodWordTableLength = goodWordTableMask = goodWordCount = 0;
+	exactWordTable = oldExactWordTable = NULL;
+	exactWordTableMask = exactWordCount = 0;
+	kickSeed = 1;
+	ignoredWords = NULL;
+	ignoredLength = ignoredRoom = 0;
+	// initialize the word columns and all wordfiles
+	wordCount = 1; // id 0 is not used
+	wordRoom = 0;
+	wordOffsets = NULL;
+	wordLengths = NULL;
+	reducedStarts = NULL;
+	reducedLengths = NULL;
+	signatures = NULL;
+	reducedBlob = NULL;
+	reducedBlobLength = reducedBlobRoom = 0;
+	initAlphabet();
+	scoredCandidates = boundedCandidates = 0;
+	trieNodes = NULL;
+	trieNodeCount = trieNodeRoom = 0;
+	trieNextWords = NULL;
+	trieNextRoom = 0;
+	trieDistance = 0;
+	editRanking = false;
+	trieLookups = trieVisits = 0;
+	deletionBuckets = NULL;
+	deletionChecks = NULL;
+	deletionIds = NULL;
+	deletionCount = 0;
+	deletionIndexed = 0;
+	deletionLength = -1;
+	deletionLimit = twoDeletionBytes;
 	memset(wordFiles, 0, (NUMDICTFILES+1) * sizeof(wordFiles[0]));
 	fileNumber = 0; // assimilateFile will start with file #1.
-	assimilateFile(dictFile);
+	if (!assimilateFile(dictFile)) {
+		throw(noSuchFile);
+	}
 } // uSpell::uSpell
 
 uSpell::~uSpell() {
 	int index;
 	// fprintf(stdout, "deallocator called\n");
 	for (index = 0; index <= NUMDICTFILES; index += 1) {
-		if (wordFiles[index] != NULL) fclose(wordFiles[index]);
+		if (wordFiles[index].mapped) {
+			unmapFile(wordFiles[index].text, wordFiles[index].length);
+		} else if (wordFiles[index].room) { // arena
+			free(wordFiles[index].text);
+		}
+	}
+	if (reducedWordTableOwned) free(reducedWordTable);
+	if (oldReducedWordTable && oldReducedWordTableOwned) {
+		free(oldReducedWordTable);
+	}
+	if (goodWordTableOwned) free(goodWordTable);
+	free(newGoodWordTable);
+	if (exactWordTableOwned) free(exactWordTable);
+	if (oldExactWordTable && oldExactWordTableOwned) {
+		free(oldExactWordTable);
+	}
+	free(ignoredWords);
+	if (image != NULL) { // some tables may still be part of the image
+		unmapFile(image, imageLength);
+	}
+	if (wordRoom) { // the columns are not part of the image
+		free(wordOffsets);
+		free(wordLengths);
+		free(reducedStarts);
+		free(reducedLengths);
+		free(signatures);
 	}
-	free(reinterpret_cast<char *>(reducedWordTable));
-	free(reinterpret_cast<char *>(goodWordTable));
+	if (reducedBlobRoom) free(reducedBlob); // not part of the image
+	free(alphabetPages);
+	free(alphabetCodes);
+	free(trieNodes);
+	free(trieNextWords);
+	freeDeletions();
 	myTranscribe->~transcriber();
 } // ~uSpell
 
 void uSpell::ignoreWord(const utf8_t *string) {
-	int length;
-	wide_t bigBuf[BUFLEN];
-	length = utf8_wide(bigBuf, string, BUFLEN);
-	ignoreWord(bigBuf, length);
+	utf8_t buffer[keyRoom+1];
+	const utf8_t *key;
+	int length = strlen(reinterpret_cast<const char *>(string));
+	key = utf8Key(string, &length, buffer);
+	ignoreKey(key, length);
 } // ignoreWord
 
-bool uSpell::isSpelledRight(const wide_t *string, const int length) {
-	int hashVersion;
-	int hashValue;
-	int loc, offset;
-	for (hashVersion = 1; hashVersion <= maxHashVersion; hashVersion++) {
-		hashValue = hash2(string, length, hashVersion) &
-			goodWordTableMask;
-		loc = hashValue >> 5;
-		offset = 1 << (hashValue & 0x1f);
-		if (goodWordTable[loc] & offset) {
-			// fprintf(stdout, "found with hashversion %d\n", hashVersion);
-		} else {
-			// fprintf(stdout, "not found with hashVersion %d\n", hashVersion);
-			return(0);
-		}
-	}
-	return(1); // found
-} // isSpelledRight
-
 int uSpell::isSpelledRightMultiple(wide_t *string, const int length) {
 	if (isSpelledRight(string, length)) return(length);
 	int divide;
@@ -418,12 +969,14 @@ int uSpell::isSpelledRightMultiple(wide_t *string, const int length) {
 } // isSpelledRightMultiple
 
 // return the sum of the number of letters in each string not in the other.
-int uSpell::wordDiff(const wide_t *string1, const int string1Length,
-		const wide_t *string2, const int string2Length) {
+// Letters are wide_t characters or alphabet codes; neither is ever 0.
+template <class letter_t>
+static int unmatchedLetters(const letter_t *string1, const int string1Length,
+		const letter_t *string2, const int string2Length, const int spread) {
 	int index1, index2, answer;
-	wide_t tmp[BUFLEN];
+	letter_t tmp[BUFLEN];
 	answer = 0;
-	memcpy((void *) tmp, (void *) string2, sizeof(wide_t)*string2Length);
+	memcpy((void *) tmp, (void *) string2, sizeof(letter_t)*string2Length);
 	for (index1 = 0; index1 < string1Length; index1++) {
 		// seek string1[index1] nearby in tmp
 		answer += 1; // we haven't found it.
@@ -437,7 +990,7 @@ int uSpell::wordDiff(const wide_t *string1, const int string1Length,
 			}
 		}
 	} // seek string1[index1]
-	memcpy((void *) tmp, (void *) string1, sizeof(wide_t)*string1Length);
+	memcpy((void *) tmp, (void *) string1, sizeof(letter_t)*string1Length);
 	for (index2 = 0; index2 < string2Length; index2++) {
 		// seek string2[index2] nearby in tmp
 		answer += 1; // we haven't found it.
@@ -452,4 +1005,152 @@ int uSpell::wordDiff(const wide_t *string1, const int string1Length,
 		}
 	} // seek string2[index2]
 	return(answer);
+} // unmatchedLetters
+
+// The codes must not include escapeCode in both strings.
+int uSpell::wordDiff(const unsigned char *codes1, const int codes1Length,
+		const unsigned char *codes2, const int codes2Length) {
+	return(unmatchedLetters(codes1, codes1Length, codes2, codes2Length,
+		spread));
+} // wordDiff
+
+// Return the lowest count bits.
+static inline __uint64_t lowBits(const int count) {
+	return(count >= 64 ? ~static_cast<__uint64_t>(0) :
+		(static_cast<__uint64_t>(1) << count) - 1);
+} // lowBits
+// unmatchedLetters() for two strings of at most maskedLength codes, each
+// placed after spread bytes and readable for 16 bytes past its last multiple
+// of 16; what lies in those bytes doesn't matter.  Bit k of near1[i] tells
+// whether letter i of the first string equals letter i-spread+k of the second,
+// and near2[] tells the same the other way; SSE2 finds sixteen of each with
+// 2*spread+1 compares.  Each pass of unmatchedLetters() then takes, for each
+// letter, the lowest of those bits whose letter is still free, without a
+// branch.  We return once the count passes limit; the answer is then only
+// some number past limit.
+template <int spread>
+static int maskedDiff(const unsigned char *codes1, const int length1,
+		const unsigned char *codes2, const int length2, const int limit) {
+	unsigned char near1[64+16], near2[64+16];
+	__uint64_t free, choice;
+	int index, shift, answer;
+	const int longer = length1 > length2 ? length1 : length2;
+#ifdef CODES_SSE2
+	for (index = 0; index < longer; index += 16) {
+		__m128i here1 = _mm_loadu_si128(
+			reinterpret_cast<const __m128i *>(codes1 + spread + index));
+		__m128i here2 = _mm_loadu_si128(
+			reinterpret_cast<const __m128i *>(codes2 + spread + index));
+		__m128i pattern1 = _mm_setzero_si128();
+		__m128i pattern2 = _mm_setzero_si128();
+		for (shift = 0; shift <= 2*spread; shift += 1) {
+			__m128i bit = _mm_set1_epi8(1 << shift);
+			pattern1 = _mm_or_si128(pattern1, _mm_and_si128(bit,
+				_mm_cmpeq_epi8(here1, _mm_loadu_si128(
+				reinterpret_cast<const __m128i *>(codes2 + index + shift)))));
+			pattern2 = _mm_or_si128(pattern2, _mm_and_si128(bit,
+				_mm_cmpeq_epi8(here2, _mm_loadu_si128(
+				reinterpret_cast<const __m128i *>(codes1 + index + shift)))));
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(near1 + index),
+			pattern1);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(near2 + index),
+			pattern2);
+	}
+#else
+	for (index = 0; index < longer; index += 1) {
+		near1[index] = near2[index] = 0;
+		for (shift = 0; shift <= 2*spread; shift += 1) {
+			near1[index] |= (codes1[spread + index] ==
+				codes2[index + shift]) << shift;
+			near2[index] |= (codes2[spread + index] ==
+				codes1[index + shift]) << shift;
+		}
+	}
+#endif
+	answer = 0;
+	free = lowBits(length2) << spread; // letters of the second string
+	for (index = 0; index < length1; index += 1) {
+		choice = near1[index] & (free >> index);
+		free ^= (choice & -choice) << index;
+		answer += choice == 0;
+	}
+	if (answer > limit) return(answer);
+	free = lowBits(length1) << spread; // letters of the first string
+	for (index = 0; index < length2; index += 1) {
+		choice = near2[index] & (free >> index);
+		free ^= (choice & -choice) << index;
+		answer += choice == 0;
+	}
+	return(answer);
+} // maskedDiff
+
+// Place in scores[] the wordDiff() of each of the count words in wordIds[]
+// from the target, or some number past limit if it is bigger than that.
+void uSpell::wordDiffs(const target_t *target, const wordId_t *wordIds,
+		const int count, int *scores, const int limit) {
+	unsigned char codes[spread + maskedLength + spread + 16]; // a word, as
+		// maskedDiff() wants it
+	int index, length;
+	memset(codes, 0, sizeof(codes));
+	for (index = 0; index < count; index += 1) {
+		const wordId_t wordId = wordIds[index];
+		const unsigned char *reduced = reducedBlob + reducedStarts[wordId];
+		length = reducedLengths[wordId];
+		if (target->escaped && memchr(reduced, escapeCode, length)) {
+			// escapeCode may stand for different characters; compare the
+			// characters themselves
+			wide_t bigBuf[BUFLEN], reduceBuf[BUFLEN];
+			int bigLength, reduceLength;
+			bigLength = utf8_wide(bigBuf, wordAt(wordId), wordLengths[wordId],
+				BUFLEN);
+			reduceWord(reduceBuf, &reduceLength, bigBuf, bigLength,
+				myTranscribe);
+			scores[index] = wordDiff(reduceBuf, reduceLength,
+				target->characters, target->length);
+		} else if (length > maskedLength || target->length > maskedLength) {
+			scores[index] = wordDiff(reduced, length, target->codes,
+				target->length);
+		} else {
+			memcpy(codes + spread, reduced, length);
+			scores[index] = maskedDiff<spread>(codes, length, target->window,
+				target->length, limit);
+		}
+	}
+} // wordDiffs
+
+// Place in scores[] the edit distance of each of the count words in wordIds[]
+// from the target.
+void uSpell::editDiffs(const target_t *target, const wordId_t *wordIds,
+		const int count, int *scores) {
+	int index, length;
+	for (index = 0; index < count; index += 1) {
+		const wordId_t wordId = wordIds[index];
+		const unsigned char *reduced = reducedBlob + reducedStarts[wordId];
+		length = reducedLengths[wordId];
+		if (target->escaped && memchr(reduced, escapeCode, length)) {
+			// escapeCode may stand for different characters; compare the
+			// characters themselves
+			wide_t bigBuf[BUFLEN], reduceBuf[BUFLEN];
+			int bigLength, reduceLength;
+			bigLength = utf8_wide(bigBuf, wordAt(wordId), wordLengths[wordId],
+				BUFLEN);
+			reduceWord(reduceBuf, &reduceLength, bigBuf, bigLength,
+				myTranscribe);
+			scores[index] = editDistance(reduceBuf, reduceLength,
+				target->characters, target->length);
+		} else if (target->length > editMaskLength) {
+			scores[index] = editDistance(reduced, length, target->codes,
+				target->length);
+		} else {
+			scores[index] = maskedEditDistance(target->masks, target->length,
+				reduced, length);
+		}
+	}
+} // editDiffs
+
+int uSpell::wordDiff(const wide_t *string1, const int string1Length,
+		const wide_t *string2, const int string2Length) {
+	return(unmatchedLetters(string1, string1Length, string2, string2Length,
+		spread));
 } // wordDiff
@@ -33,17 +33,45 @@ class uSpell {
 			// might have precomposed versions.  This information is not used
 			// directly by uspell, but it can guide the application that uses
 			// uspell.
+		static const char exactMembership = 1<<4;
+			// if set, isSpelledRight() is exact: it uses a cuckoo table that
+			// checks each word against the stored word instead of a Bloom
+			// filter, which sometimes accepts misspellings.  It takes more
+			// memory, but words can be removed with removeWord().
+		static const char multiplyHash = 1<<5;
+			// if set, the tables are hashed by the wide-multiplication
+			// backend of wordhash.h instead of Jenkins' hashlong().  Run
+			// "make hashbench" in src to compare them.
+		static const char twoDeletions = 1<<6;
+			// if set, showAlternatives() finds every word whose reduced form
+			// is within two insertions, omissions, replacements or adjacent
+			// transpositions of the misspelling's, and ranks them by that
+			// distance, using an index of the reduced forms with up to two
+			// codes omitted (see deletions.cpp).  The index is built when it
+			// is first needed and takes at most the memory limitTwoDeletions()
+			// allows, keeping the shortest words; a misspelling that could
+			// be close to a word it leaves out is looked up in the
+			// reducedWordTable as usual.  suggestWithin() takes precedence.
+		static const int twoDeletionLength = 20; // longest reduced form
+			// the twoDeletions index takes
+		static const size_t twoDeletionBytes = 32 << 20; // the default limit
+			// of the twoDeletions index
 #		define NUMDICTFILES 7
 			// number of open dictionary files per uspell object
 			// The last one is reserved, so one fewer is actually allowed
 			// Number 1 is the regular dictionary, 2 .. NUMDICTFILES-1 are
 			// supplemental.
+		static const int keyRoom = 4*BUFLEN;
+			// bytes in the UTF-8 form of the longest word the goodWordTable
+			// keeps
 	// variables
 		char theFlags; // should be read-only to applications
 	// exceptions
 		static const int noSuchFile = 1; // can't open the dictFile
 		static const int noMem = 2; // out of memory
 		static const int fileOpen = 3; // some file can't be opened
+		static const int badImage = 4; // the image is malformed, from another
+			// version, or built with a different transcription file
 	// procedures
 		uSpell(const char *dictFile, const char *transcriptionFile,
 			const char flags);
@@ -56,7 +84,18 @@ class uSpell {
 			// expanded form as properly spelled.  It is about 20% faster to
 			// leave this flag off, which has identical behavior if
 			// languageFile is fully expanded, with no precomposed characters.
+		uSpell(const char *imageFile, const char *transcriptionFile);
+			// initializer from a precompiled image, as written by
+			// writeImage().  The image is mapped into memory, so this is much
+			// faster than assimilating the dictionary.  The flags are taken
+			// from the image.  The transcriptionFile must be the same one
+			// used to build the image.
 		~uSpell(); // finalizer
+		bool writeImage(const char *imageFile);
+			// writes the tables and the main dictionary into a single file
+			// that the image initializer can use later.  Call it right after
+			// initializing; it returns false if supplemental files or words
+			// have been added, or if the file can't be written.
 		bool assimilateFile(const char* wordFileName);
 			// The newFile should be a newline-delimited list of utf8-encoded
 			// words of the language.  Returns false if there is a problem,
@@ -64,6 +103,9 @@ class uSpell {
 			// malformed file.
 		bool isSpelledRight(const wide_t *string, const int length);
 			// length is in wide_t units, not bytes.
+		bool isSpelledRight(const utf8_t *string, const size_t length);
+			// length is in bytes.  The fastest check: a valid UTF-8 word is
+			// looked up as it is, without conversion.
 		int isSpelledRightMultiple(wide_t *string, const int length);
 			// The string is considered spelled right if it is the combination
 			// of two words, both spelled right.
@@ -79,65 +121,359 @@ class uSpell {
 		void acceptWord(const utf8_t *string); // null-terminated
 			// the given word is now taken as correctly spelled and can become
 			// a suggestion for a misspelling.
+		bool removeWord(const utf8_t *string); // null-terminated
+			// the given word is no longer taken as correctly spelled, nor
+			// given as a suggestion.  Returns false if the word was not
+			// known, or if the instance was not initialized with
+			// exactMembership.
+		bool removeWord(const wide_t *string, const int length);
+			// length is in wide_t units.
 		int showAlternatives(const wide_t *probe, const int length,
 			utf8_t **list, const int maxAlternatives);
 			// returns count of alternative good spellings of 'probe', placed
-			// in 'list', not to exceed 'maxAlternatives'.   The alternatives
-			// are in newly allocated space; the caller should free() when
-			// done.
+			// in 'list', best first, not to exceed 'maxAlternatives' or
+			// BUFLEN.   The alternatives are in newly allocated space; the
+			// caller should free() when done.
+		int showAlternatives(const utf8_t *probe, const size_t length,
+			utf8_t **list, const int maxAlternatives);
+			// length is in bytes.  Returns 0 without converting 'probe' if
+			// it is spelled right.
+		void suggestWithin(const int distance);
+			// if distance is positive, showAlternatives() walks a trie of
+			// the words instead of looking up variants of the misspelling,
+			// and finds exactly the words whose reduced forms are within
+			// distance insertions, omissions, replacements or adjacent
+			// transpositions of its reduced form (at most 3): fewest edits
+			// first, and of those, the closest by the usual measure.  The
+			// trie is built on the first call.  0, the default, looks up
+			// variants.
+		void limitTwoDeletions(const size_t bytes);
+			// with twoDeletions, the most memory its index may take, in
+			// bytes; twoDeletionBytes by default.  The index keeps the
+			// shortest words that fit.  A new limit takes effect when the
+			// index is next needed.
+		void rankByEdits(const bool byEdits);
+			// if byEdits, showAlternatives() ranks the words it finds in
+			// the reducedWordTable by the edit distance of their reduced
+			// forms from the misspelling's, counting insertions, omissions,
+			// replacements and adjacent transpositions, and suggests none
+			// more than maxEdits away, instead of by the number of letters
+			// of each not found near the same place in the other.  Ties go
+			// to the words found first, as before.  It doesn't change what
+			// suggestWithin() finds.
+		double falsePositiveRate();
+			// the estimated chance that isSpelledRight() accepts a word that
+			// was never added.
+		void reportStatistics(FILE *outFile);
+			// describes the tables on outFile: their sizes and loads, the
+			// displacements in the reducedWordTable, how many cache lines a
+			// lookup there touches, how many suggestion candidates were
+			// scored and skipped, the alphabet, the trie and the
+			// twoDeletions index if there are any, and the size of the
+			// transcriber.
 
 	private:
 
 	// types
 		typedef __uint32_t fileOffset_t;
 			// offsetBits of the offset; upper 3 bits are the file number
-			// Hash tables hold fileOffset_t values, not strings
+		typedef __uint32_t wordId_t;
+			// Every word that can be suggested has an id, which indexes the
+			// word columns.  Id 0 is not used, so an empty table slot is 0.
+			// Hash tables hold wordId_t values, not strings
 	// constants
 		static const int maxDistance = 3; // word distance; don't suggest bigger
-		static const int maxHashVersion = 5; // number of independent bit hashes
+		static const int maxEdits = 2; // the same, with rankByEdits()
+		static const int bucketSlots = 8; // slots per cache line
+		static const int minTableLength = 1024; // in slots or bits
+		static const int goodFalsePositiveOdds = 10000; // the goodWordTable
+			// should find about 1 in this many wrong words
+		static const int goodGrowthRate = 4; // it grows when it finds this
+			// many
+		static const int maxGoodProbes = 16; // bits per word in it
+		static const int exactBucketSlots = 8; // per cache line
+		static const int maxKicks = 256; // cuckoo evictions before growing
+		static const int exactMigrationStep = 2; // old buckets moved per
+			// addition while the exactWordTable grows
+		static const __uint32_t ignoredRef = 0x80000000; // marks an
+			// exactSlot_t ref as an ignored word
+		static const fileOffset_t removedWord = 0; // wordOffsets value of a
+			// removed word; file 0 is not used
+		static const int reducedMigrationStep = 2; // old buckets moved per
+			// insertion while the reducedWordTable grows
+		static const int goodMigrationStep = 4; // words moved per addition
+			// while the goodWordTable grows
 		static const int spread = 2; // difference between words looks for same
 			// char within this distance.
 		static const int infinity = 100000;
+		static const int heldBits = 8; // of a heldIds index
+		static const int heldRoom = 1 << heldBits; // at least 2*BUFLEN
+		static const int maskedLength = 64 - spread; // longest reduced form
+			// that wordDiffs() compares with bit masks
+		static const int candidateRoom = 32; // words addTableMatches()
+			// scores at once
+		static const int alphabetRoom = 256; // codes of one byte
+		static const unsigned char escapeCode = 255; // the code of every
+			// character outside the alphabet
+		static const wide_t alphabetLimit = 0x110000; // characters from
+			// here up have no code
+		static const int maxTrieLength = 63; // longest reduced misspelling
+			// whose automaton states fit in 64 bits
+		static const int trieTieScale = 16; // the goodness of the trie and
+			// deletion engines is this times the edit distance, plus the
+			// wordDiff() below it
 		static const int offsetBits = 29;  // bits used to actually hold offset
 		static const fileOffset_t offsetMask = ~(0xffffffff << offsetBits);
 
 	// types
-		typedef fileOffset_t *hashTable;
 		typedef struct {
-			fileOffset_t fileOffset; // offset into wordFile
+			utf8_t *text; // contents of the file; newline-delimited words
+			size_t length; // in bytes
+			size_t room; // bytes allocated; 0 unless we own the text: a
+				// supplemental file we read, or the arena
+			bool mapped; // text was mapped by assimilateFile(); only the
+				// main dictionary is
+		} wordFile_t;
+		typedef __uint32_t *hashTable;
+		typedef struct {
+			__uint32_t hash; // of the key
+			wordId_t wordId; // 0 if the slot is empty
+		} slot_t; // one entry of the reducedWordTable
+		typedef struct {
+			__uint32_t check; // high half of the key's hash
+			__uint32_t ref; // word id, or ignoredRef + offset into
+				// ignoredWords; 0 if the slot is empty
+		} exactSlot_t; // one entry of the exactWordTable
+		typedef struct {
+			wordId_t wordId; // the word suggested
 			int goodness; // distance from proferred spelling; large is bad
+			int order; // in which it was found
 		} suggestion_t;
+		typedef struct {
+			const wide_t *characters; // the reduced form
+			unsigned char codes[BUFLEN]; // its alphabet codes
+			unsigned char window[spread + maskedLength + spread + 16];
+				// the codes again, after spread zeroes, if there are at
+				// most maskedLength; for maskedDiff()
+			int length; // of both
+			__uint64_t signature; // of codes
+			bool escaped; // some code is escapeCode
+			__uint64_t masks[alphabetRoom]; // the editMasks() of codes;
+				// only for the trie engine and rankByEdits()
+		} target_t; // a reduced misspelling, as addMatches() compares it
+		typedef struct {
+			__uint32_t firstChild; // 0 if none; the root is never a child
+			__uint32_t nextSibling; // 0 if none
+			wordId_t firstWord; // whose reduced form ends here; 0 if none
+			unsigned char code; // that leads here from the parent
+		} trieNode_t; // see trie.cpp
+		typedef struct {
+			__uint64_t accept; // bit of the target's length
+			__uint64_t live; // bits up to accept
+			int distance; // the edits of the words this pass suggests
+			const target_t *target;
+		} trieProbe_t; // a target, as walkTrie() compares it
 
 	// variables
-		FILE *wordFile;
-		hashTable reducedWordTable; // each entry points to wordFile.
-		int reducedWordTableLength;
+		void *image; // mapped image, or NULL if we built the tables ourselves
+		size_t imageLength; // in bytes
+		__uint32_t transcriptionHash; // identifies the transcription file
+		int hashBackend; // of wordhash.h; from theFlags
+		slot_t *reducedWordTable; // Robin Hood table; see uspell.cpp
+		int reducedWordTableLength; // in slots, a power of 2
 		int reducedWordTableMask;
-		hashTable goodWordTable;
-			// each good word hashed HASHNUM times to a bit.
-		int goodWordTableLength;
-		int goodWordTableMask;
-		suggestion_t suggestions[BUFLEN]; // kept sorted, best first
+		int reducedWordCount; // slots in use
+		bool reducedWordTableOwned; // false if it is in the image
+		slot_t *oldReducedWordTable; // being moved to reducedWordTable, or
+			// NULL
+		int oldReducedWordTableMask;
+		bool oldReducedWordTableOwned;
+		int migratedBuckets; // of oldReducedWordTable, moved so far
+		hashTable goodWordTable; // blocked Bloom filter; see goodwords.cpp
+		int goodWordTableLength; // in 32-bit words
+		int goodWordTableMask; // in bits
+		int goodProbes; // bits per word
+		int goodWordCount; // words added
+		int goodWordLimit; // it should grow past this many words
+		bool goodWordTableOwned; // false if it is in the image
+		hashTable newGoodWordTable; // being filled to replace goodWordTable,
+			// or NULL
+		int newGoodWordTableMask;
+		int newGoodProbes;
+		wordId_t goodMigratedIds; // words put in newGoodWordTable so far
+		size_t goodMigratedIgnored; // ignoredWords put there so far
+		exactSlot_t *exactWordTable; // cuckoo table, if exactMembership
+		int exactWordTableMask; // in slots
+		int exactWordCount; // words in it
+		bool exactWordTableOwned; // false if it is in the image
+		exactSlot_t *oldExactWordTable; // being moved to exactWordTable, or
+			// NULL
+		int oldExactWordTableMask;
+		bool oldExactWordTableOwned;
+		int exactMigratedBuckets; // of oldExactWordTable, moved so far
+		__uint32_t kickSeed; // chooses cuckoo victims
+		utf8_t *ignoredWords; // each is its key length in two bytes, low
+			// first, then its key
+		size_t ignoredLength; // in bytes
+		size_t ignoredRoom;
+		suggestion_t suggestions[BUFLEN]; // a heap, worst first; see
+			// uspell.cpp
 		int suggestionCount;
+		int suggestionLimit; // the most suggestions wanted
+		int suggestionWorst; // the largest goodness they may have
+		int suggestionOrder; // suggestions found so far
+		wordId_t heldIds[heldRoom]; // hash set of the suggestions' words
+		unsigned long scoredCandidates; // words showAlternatives() has
+			// scored
+		unsigned long boundedCandidates; // words it skipped for their
+			// diffBound()
+		trieNode_t *trieNodes; // the trie of reduced forms, or NULL if
+			// suggestWithin() hasn't built it
+		int trieNodeCount, trieNodeRoom;
+		wordId_t *trieNextWords; // by word id, the next word whose reduced
+			// form ends at the same node; 0 if none
+		wordId_t trieNextRoom; // ids that fit in trieNextWords
+		int trieDistance; // set by suggestWithin(); 0 for the hash engine
+		bool editRanking; // set by rankByEdits()
+		unsigned long trieLookups; // misspellings the trie has looked up
+		unsigned long trieVisits; // nodes those lookups visited
+		__uint32_t *deletionBuckets; // the twoDeletions index, or NULL if
+			// it isn't built; see deletions.cpp.  The first entry of each
+			// bucket, and one past the last
+		int deletionBucketMask; // buckets, less 1
+		__uint16_t *deletionChecks; // by entry, the high half of the hash of
+			// its form
+		wordId_t *deletionIds; // by entry, its word
+		__uint32_t deletionCount; // entries
+		wordId_t deletionIndexed; // ids below this are in the index
+		int deletionLength; // longest reduced form in the index
+		size_t deletionLimit; // bytes it may take; see limitTwoDeletions()
+		wordId_t wordCount; // ids given out so far, counting the unused 0
+		wordId_t wordRoom; // ids that fit in the columns; 0 if they are in
+			// the image
+		// the word columns, indexed by wordId_t
+		fileOffset_t *wordOffsets; // where the word starts
+		__uint16_t *wordLengths; // in bytes
+		__uint32_t *reducedStarts; // where the reduced form is in reducedBlob
+		unsigned char *reducedLengths; // in characters
+		__uint64_t *signatures; // set of codes in the reduced form
+		unsigned char *reducedBlob; // the reduced forms of all words, end
+			// to end, as alphabet codes
+		__uint32_t reducedBlobLength; // in codes
+		__uint32_t reducedBlobRoom; // codes allocated; 0 if the blob is in
+			// the image
+		// the alphabet of the reduced forms; see uspell.cpp
+		wide_t alphabet[alphabetRoom]; // the character of each code; code 0
+			// is not used
+		int alphabetSize; // codes given out, counting the unused 0
+		__uint16_t *alphabetPages; // by character >> 8, its page of
+			// alphabetCodes; page 0 has no codes
+		unsigned char *alphabetCodes; // pages of codes, by character & 255
+		int alphabetPageCount; // pages in alphabetCodes
 		class transcriber *myTranscribe;
+		void (*reduceWord)(wide_t *dest, int *destLength,
+			const wide_t *source, int sourceLength,
+			class transcriber *transcribePtr);
+			// reduce(), specialized for our flags and transcriber; see
+			// reducerFor()
+		void (*reduceProbe)(wide_t *dest, int *destLength,
+			const wide_t *source, int sourceLength,
+			class transcriber *transcribePtr);
+			// the same, never expanding precomposed characters
 		int fileNumber; // which file we are working on
-		FILE *wordFiles[NUMDICTFILES+1]; // wordFile[0] is not used.
+		wordFile_t wordFiles[NUMDICTFILES+1]; // wordFile[0] is not used.
 			// wordFile[1] is the main dictionary
 			// wordFile[1..NUMDICTFILES-1] are read in by assimilateFile();
-			// wordFile[NUMDICTFILES] is for accepted but not filed words.
+			// wordFile[NUMDICTFILES] is an arena for accepted but not filed
+			// words.
 		
 	// private routines
-		bool inGoodWordTable(const wide_t *string, const int length);
-		void insertReducedWordTable(const wide_t *string, const int length,
-			const fileOffset_t aValue, const int fileNumber);
-		void initSuggestions();
-		void addSuggestion(const fileOffset_t fileOffset, const int goodness);
-		void addMatches(const wide_t *probe, const int probeLength,
-			const wide_t *target, const int targetLength);
+		const utf8_t *utf8Key(const utf8_t *string, int *length,
+			utf8_t *buffer);
+		const utf8_t *wordKey(const utf8_t *string, int *length,
+			utf8_t *buffer);
+		int wideWordKey(const wide_t *string, int length, utf8_t *key);
+		bool inGoodWordTable(const utf8_t *key, const int length);
+		void chooseGoodSize(const int words, int *bits, int *probes);
+		int goodLimit(const int bits, const int probes);
+		void reserveGoodWords(const int words);
+		void addGoodWord(const utf8_t *key, const int length,
+			const __uint32_t ref);
+		void ignoreKey(const utf8_t *key, const int length);
+		bool removeKey(const utf8_t *key, const int length);
+		const utf8_t *goodKey(const __uint32_t ref, utf8_t *buffer,
+			int *length);
+		exactSlot_t *findExact(const utf8_t *key, const int length);
+		exactSlot_t *findExactIn(exactSlot_t *table, const int mask,
+			const int migrated, const __uint32_t check,
+			const utf8_t *key, const int length);
+		bool placeExact(exactSlot_t *table, const int mask,
+			exactSlot_t *entry);
+		exactSlot_t *allocateExactWordTable(const int length);
+		void startExactMigration(const int length);
+		void migrateExactBuckets(int count);
+		void rebuildExact(exactSlot_t homeless);
+		void startGoodMigration(const int bits, const int probes);
+		void migrateGoodWords(int count);
+		void insertReducedWordTable(const __uint32_t hashValue,
+			const wordId_t wordId);
+		int displacementAt(const slot_t *table, const int mask,
+			const int position);
+		bool unmigrated(const __uint32_t hashValue);
+		bool holdsReducedEntry(const slot_t *table, const int mask,
+			const slot_t entry);
+		void placeReducedEntry(slot_t entry, const bool beforeKey);
+		void allocateReducedWordTable(const int length);
+		void startReducedMigration(const int length);
+		void migrateReducedBuckets(int count);
+		void reserveTables(const int words, const int entries);
+		void settleTables();
+		void initSuggestions(const int limit, const int worst);
+		int acceptableGoodness();
+		int heldSlot(const wordId_t wordId);
+		void dropHeld(const wordId_t wordId);
+		void siftSuggestion(int index, const suggestion_t entry,
+			const int count);
+		void addSuggestion(const wordId_t wordId, const int goodness);
+		void sortSuggestions();
+		void initAlphabet();
+		void addToAlphabet(const wide_t c);
+		unsigned char codeOf(const wide_t c);
+		bool encode(unsigned char *dest, const wide_t *source,
+			const int length, const bool extend);
+		void addMatches(const __uint32_t hashValue, const target_t *target);
+		void addTableMatches(const slot_t *table, const int mask,
+			const __uint32_t hashValue, const target_t *target);
+		void addCandidates(const target_t *target, const wordId_t *wordIds,
+			const int count);
+		int wordDiff(const unsigned char *codes1, const int codes1Length,
+			const unsigned char *codes2, const int codes2Length);
 		int wordDiff(const wide_t *string1, const int string1Length,
 			const wide_t *string2, const int string2Length);
-		void acceptGoodWord(const utf8_t *buf, int wordPosition,
-			int fileNumber);
+		void wordDiffs(const target_t *target, const wordId_t *wordIds,
+			const int count, int *scores, const int limit);
+		void editDiffs(const target_t *target, const wordId_t *wordIds,
+			const int count, int *scores);
+		void insertTrie(const wordId_t wordId);
+		void placeChildren(const trieNode_t *oldNodes, trieNode_t *newNodes,
+			const int node, int *count);
+		void addTrieWords(const int node, const int distance,
+			const trieProbe_t *probe);
+		bool trieOpen(const int distance);
+		bool walkTrie(const int node, const __uint64_t *states,
+			const __uint64_t *before, const trieProbe_t *probe);
+		void trieAlternatives(const target_t *target);
+		int omissionHashes(const unsigned char *codes, const int length,
+			__uint32_t *hashes);
+		void freeDeletions();
+		void buildDeletions();
+		bool deletionsCover(const int length);
+		void deletionAlternatives(const target_t *target);
+		void acceptGoodWord(const utf8_t *buf, int bufLength,
+			int wordPosition, int fileNumber);
+		wordId_t newWord(const fileOffset_t wordOffset, const int wordLength,
+			const wide_t *reduced, const int reducedLength);
+		const utf8_t *wordAt(const wordId_t wordId);
 }; // class uSpell
 
 #endif /* USPELL_H */
@@ -6,151 +6,312 @@
 // Conversion routines between UTF8 and UCS (typically UCS4) representations.
 //
 // utf8_wide: from UTF8 to UCS
+// utf8_count: validate UTF8 and count its characters
 // wide_utf8: from UCS to UTF8
 // makeUTF: from UCS to UTF8, places result in volatile temporary location
+//
+// Both directions follow RFC 3629: a character is at most 4 bytes of UTF-8 and
+// at most 0x10FFFF, and neither overlong forms nor surrogates are valid.
+// utf8_wide converts a leading run of ASCII eight bytes at a time, and with
+// SSE2 also blocks of four two-byte characters (Hebrew, Yiddish, Cyrillic,
+// Greek ...) at once; wide_utf8 converts blocks of four ASCII characters at
+// once.  Other characters take the general path.
 
 #include <stdlib.h>
+#include <string.h>
 
+#include "myparameters.h"
 #include "utf8convert.h"
+#ifdef WIDE_SSE2
+#include <emmintrin.h>
+#endif
 
 #define LINELEN 10000
 
-// Converters between utf8 and UCS
-
-// from Vim code, by Bram Moolenaar
-
-/* Lookup table to quickly get the length in bytes of a UTF-8 character from
- * the first byte of a UTF-8 string.  Bytes which are invalid when used as the
- * first byte have a one, because these will be used separately. */
-static char utf8len_tab[256] =
-{
-    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
-    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
-    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
-    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
-    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, /*bogus*/
-    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, /*bogus*/
-    2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
-    3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,4,4,4,4,4,4,4,4,5,5,5,5,6,6,1,1,
-};
+// Decode the UTF-8 character at p, which is before end, into *c.  Return its
+// length in bytes, or 0 if it is invalid or truncated by end.
+static inline int decodeOne(const unsigned char *p, const unsigned char *end,
+		wide_t *c) {
+	wide_t answer, least; // least: the smallest value of this length
+	int length, index;
+	if (p[0] < 0x80) {
+		*c = p[0];
+		return(1);
+	} else if (p[0] < 0xc2) { // continuation byte or overlong 2-byte form
+		return(0);
+	} else if (p[0] < 0xe0) {
+		length = 2;
+		answer = p[0] & 0x1f;
+		least = 0x80;
+	} else if (p[0] < 0xf0) {
+		length = 3;
+		answer = p[0] & 0x0f;
+		least = 0x800;
+	} else if (p[0] < 0xf5) {
+		length = 4;
+		answer = p[0] & 0x07;
+		least = 0x10000;
+	} else { // obsolete 5- and 6-byte forms, or beyond 0x10FFFF
+		return(0);
+	}
+	if (end - p < length) return(0); // truncated
+	for (index = 1; index < length; index += 1) { // one continuation byte
+		if ((p[index] & 0xc0) != 0x80) return(0);
+		answer = (answer << 6) + (p[index] & 0x3f);
+	} // one continuation byte
+	if (answer < least || answer > 0x10ffff ||
+			(answer >= 0xd800 && answer <= 0xdfff))
+		return(0); // overlong, too large, or a surrogate
+	*c = answer;
+	return(length);
+} // decodeOne
 
-/*
- * Convert a UTF-8 byte sequence to wide characters.  If the sequence is
- * invalid or truncated by a NUL the first byte is returned.  Return the number
- * of wide characters constructed.  Don't go beyong outLength.
- */
-int utf8_wide(wide_t *dest, const utf8_t *source, int outLength){
-    int		len;
+// Tell whether the eight bytes at p are ASCII.
+static inline int asciiEight(const unsigned char *p) {
+	__uint64_t bytes;
+	memcpy(&bytes, p, 8);
+	return((bytes & 0x8080808080808080ULL) == 0);
+} // asciiEight
+
+// If the eight bytes at p are ASCII, widen them into dest and return 1.
+static inline int asciiBlock(wide_t *dest, const unsigned char *p) {
+#ifdef WIDE_SSE2
+	__m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p));
+	if (_mm_movemask_epi8(bytes) != 0) return(0); // not all ASCII
+	const __m128i zero = _mm_setzero_si128();
+	__m128i shorts = _mm_unpacklo_epi8(bytes, zero);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(dest),
+		_mm_unpacklo_epi16(shorts, zero));
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(dest + 4),
+		_mm_unpackhi_epi16(shorts, zero));
+#else
+	int index;
+	if (!asciiEight(p)) return(0);
+	for (index = 0; index < 8; index += 1) dest[index] = p[index];
+#endif
+	return(1);
+} // asciiBlock
+
+#ifdef WIDE_SSE2
+// If the eight bytes at p are four valid two-byte characters, decode them into
+// dest and return 1.  Each 16-bit lane holds one character: lead byte low,
+// continuation byte high.
+static inline int twoByteBlock(wide_t *dest, const unsigned char *p) {
+	__m128i pairs = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p));
+	const __m128i zero = _mm_setzero_si128();
+	// lead 110xxxxx and continuation 10xxxxxx
+	__m128i shape = _mm_cmpeq_epi16(
+		_mm_and_si128(pairs, _mm_set1_epi16((short) 0xc0e0)),
+		_mm_set1_epi16((short) 0x80c0));
+	// lead at least 0xc2, so not overlong
+	__m128i overlong = _mm_cmpeq_epi16(
+		_mm_and_si128(pairs, _mm_set1_epi16(0x1e)), zero);
+	if ((_mm_movemask_epi8(_mm_andnot_si128(overlong, shape)) & 0xff) != 0xff)
+		return(0);
+	__m128i chars = _mm_or_si128(
+		_mm_slli_epi16(_mm_and_si128(pairs, _mm_set1_epi16(0x1f)), 6),
+		_mm_and_si128(_mm_srli_epi16(pairs, 8), _mm_set1_epi16(0x3f)));
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(dest),
+		_mm_unpacklo_epi16(chars, zero));
+	return(1);
+} // twoByteBlock
+#endif
+
+// The common code of the utf8_wide routines.  Convert at most room
+// characters.  If validate, stop at an invalid character or at a full dest and
+// report it; otherwise record the first byte of an invalid character as is
+// and stop quietly at a full dest.
+static inline int convertUTF8(wide_t *dest, const utf8_t *source,
+		int sourceLength, int room, int validate, int *errorPosition) {
 	const unsigned char *p = source;
+	const unsigned char *end = source + sourceLength;
 	wide_t *oldDest = dest;
-	while (*p) { // one utf-8 character
-		if (p[0] < 0x80) {	/* be quick for ASCII */
-			if ((--outLength) == 0) break; // no more room
-			*dest++ = *p++;
+	wide_t *destEnd = dest + (room > 0 ? room : 0);
+	int length, error = 0;
+	// most words in most languages are either pure ASCII or pure non-ASCII
+	while (end - p >= 8 && destEnd - dest >= 8 && asciiBlock(dest, p)) {
+		dest += 8;
+		p += 8;
+	}
+	while (p < end) { // one utf-8 character, or a block of them
+		if (dest == destEnd) { // no more room
+			error = utf8Overflow;
+			break;
+		}
+		if (*p < 0x80) { // be quick for ASCII
+			do {
+				*dest++ = *p++;
+			} while (p < end && *p < 0x80 && dest < destEnd);
 			continue;
 		}
-		len = utf8len_tab[p[0]];
-		if ((outLength -= len) <= 0) break; // no more room
-		if ((p[1] & 0xc0) == 0x80) {
-			if (len == 2) {
-				*dest++ = ((p[0] & 0x1f) << 6) + (p[1] & 0x3f);
-				p += 2;
-				continue;
-			} else if ((p[2] & 0xc0) == 0x80) {
-				if (len == 3) {
-					*dest++ = ((p[0] & 0x0f) << 12) + ((p[1] & 0x3f) << 6)
-						+ (p[2] & 0x3f);
-					p += 3;
-					continue;
-				} else if ((p[3] & 0xc0) == 0x80) {
-					if (len == 4) {
-						*dest++ = ((p[0] & 0x07) << 18) + ((p[1] & 0x3f) << 12)
-							+ ((p[2] & 0x3f) << 6) + (p[3] & 0x3f);
-						p += 4;
-						continue;
-					} else if ((p[4] & 0xc0) == 0x80) {
-						if (len == 5) {
-							*dest++ = ((p[0] & 0x03)<<24) + ((p[1]& 0x3f) << 18)
-								+ ((p[2] & 0x3f) << 12) + ((p[3] & 0x3f) << 6)
-								+ (p[4] & 0x3f);
-							p += 5;
-							continue;
-						} else if ((p[5] & 0xc0) == 0x80 && len == 6) {
-							*dest++ = ((p[0] & 0x01) << 30)
-								+ ((p[1] & 0x3f) << 24)
-								+ ((p[2] & 0x3f) << 18) + ((p[3] & 0x3f) << 12)
-								+ ((p[4] & 0x3f) << 6) + (p[5] & 0x3f);
-							p += 6;
-							continue;
-						}
-					} // look at p[4]
-				} // look at p[3]
-			} // look at p[2]
-		} // look at p[1]
-		/* Invalid value, just record the first byte */
-		*dest++ = *p++;
-	} // while *p
+#ifdef WIDE_SSE2
+		if (end - p >= 8 && destEnd - dest >= 4 && twoByteBlock(dest, p)) {
+			dest += 4;
+			p += 8;
+			continue;
+		}
+#endif
+		length = decodeOne(p, end, dest);
+		if (length) { // valid
+			dest++;
+			p += length;
+		} else if (validate) {
+			error = utf8Invalid;
+			break;
+		} else { // just record the first byte
+			*dest++ = *p++;
+		}
+	} // one utf-8 character, or a block of them
+	if (error && validate) {
+		if (errorPosition) *errorPosition = p - source;
+		return(error);
+	}
 	return(dest - oldDest);
+} // convertUTF8
+
+/*
+ * Convert a UTF-8 byte sequence of sourceLength bytes to wide characters.  If
+ * a character is invalid or truncated by the end of the source, its first
+ * byte is recorded as is.  Return the number of wide characters constructed.
+ * Don't go beyond outLength.
+ */
+int utf8_wide(wide_t *dest, const utf8_t *source, int sourceLength,
+		int outLength){
+	return(convertUTF8(dest, source, sourceLength, outLength - 1, 0, NULL));
+} // utf8_wide
+
+/*
+ * Convert a null-terminated UTF-8 byte sequence to wide characters.
+ */
+int utf8_wide(wide_t *dest, const utf8_t *source, int outLength){
+	return(utf8_wide(dest, source,
+		strlen(reinterpret_cast<const char *>(source)), outLength));
+} // utf8_wide
+
+/*
+ * Convert a UTF-8 byte sequence of sourceLength bytes to at most outLength
+ * wide characters, validating it.  Return the number of wide characters, or
+ * utf8Invalid or utf8Overflow with the byte offset of the offending character
+ * in *errorPosition.
+ */
+int utf8_wide(wide_t *dest, const utf8_t *source, int sourceLength,
+		int outLength, int *errorPosition){
+	return(convertUTF8(dest, source, sourceLength, outLength, 1,
+		errorPosition));
 } // utf8_wide
 
+/*
+ * Return the number of characters in the UTF-8 byte sequence of sourceLength
+ * bytes, or utf8Invalid if it is not valid.
+ */
+int utf8_count(const utf8_t *source, int sourceLength){
+	const unsigned char *p = source;
+	const unsigned char *end = source + sourceLength;
+	int length, count = 0;
+	wide_t c;
+	while (end - p >= 8 && asciiEight(p)) {
+		p += 8;
+		count += 8;
+	}
+	while (p < end) { // one utf-8 character
+		if (*p < 0x80) { // be quick for ASCII
+			p++;
+		} else if (*p >= 0xc2 && *p < 0xe0 && end - p >= 2 &&
+				(p[1] & 0xc0) == 0x80) { // and for 2 bytes, most alphabets
+			p += 2;
+		} else {
+			length = decodeOne(p, end, &c);
+			if (length == 0) return(utf8Invalid);
+			p += length;
+		}
+		count += 1;
+	} // one utf-8 character
+	return(count);
+} // utf8_count
+
 /*
  * Convert a wide character string to a null-terminated UTF-8 string.  Returns
  * the number of bytes in the UTF-8 string, including the null, but not to
- * exceed outLength.  Any null wide characters are silently ignored; this rule
- * lets us convert wide strings that have omissions.
+ * exceed destLength.  Any null wide characters are silently ignored; this rule
+ * lets us convert wide strings that have omissions.  If a character is not
+ * valid Unicode, or dest is too short, return utf8Invalid or utf8Overflow
+ * with the index of the offending character in *errorPosition; dest then holds
+ * the conversion up to that character.
  */
 int wide_utf8(utf8_t *dest, int destLength, const wide_t *source,
-		int sourceLength){
+		int sourceLength, int *errorPosition){
 	utf8_t *oldDest = dest;
-	for (; sourceLength; source++, sourceLength--) {
-		if (*source == 0x00) { /* 0 bits */
+	utf8_t *destEnd = dest + destLength - 1; // leave room for the null
+	int index, error = 0;
+	if (destLength < 1) {
+		if (errorPosition) *errorPosition = 0;
+		return(utf8Overflow);
+	}
+	for (index = 0; index < sourceLength; index += 1) { // one wide_t
+		wide_t c = source[index];
+#ifdef WIDE_SSE2
+		if (c && c < 0x80 && index + 4 <= sourceLength && destEnd - dest >= 4) {
+			// try four ASCII characters
+			__m128i chars = _mm_loadu_si128(
+				reinterpret_cast<const __m128i *>(source + index));
+			const __m128i zero = _mm_setzero_si128();
+			__m128i unusual = _mm_or_si128(
+				_mm_cmpeq_epi32(chars, zero), // a null to ignore
+				_mm_or_si128(_mm_cmpgt_epi32(chars, _mm_set1_epi32(0x7f)),
+					_mm_cmplt_epi32(chars, zero))); // beyond ASCII
+			if (_mm_movemask_epi8(unusual) == 0) { // all ASCII
+				int bytes = _mm_cvtsi128_si32(_mm_packus_epi16(
+					_mm_packs_epi32(chars, zero), zero));
+				memcpy(dest, &bytes, 4);
+				dest += 4;
+				index += 3;
+				continue;
+			}
+		} // try four ASCII characters
+#endif
+		if (c == 0x00) { /* 0 bits */
 			// no effect
-		} else if (*source < 0x80)	{	/* 7 bits */ 
-			*dest++ = *source;
-			destLength -= 1;
-		} else if (*source < 0x800)	{	/* 11 bits */ 
-			*dest++ = 0xc0 + (*source >> 6);
-			*dest++ = 0x80 + (*source & 0x3f);
-			destLength -= 2;
-		} else if (*source < 0x10000) {	/* 16 bits */
-			*dest++ = 0xe0 + (*source >> 12);
-			*dest++ = 0x80 + ((*source >> 6) & 0x3f);
-			*dest++ = 0x80 + (*source & 0x3f);
-			destLength -= 3;
-		} else if (*source < 0x200000) {	/* 21 bits */
-			*dest++ = 0xf0 + (*source >> 18);
-			*dest++ = 0x80 + ((*source >> 12) & 0x3f);
-			*dest++ = 0x80 + ((*source >> 6) & 0x3f);
-			*dest++ = 0x80 + (*source & 0x3f);
-			destLength -= 4;
-		} else if (*source < 0x4000000)	{ /* 26 bits */
-			*dest++ = 0xf8 + (*source >> 24);
-			*dest++ = 0x80 + ((*source >> 18) & 0x3f);
-			*dest++ = 0x80 + ((*source >> 12) & 0x3f);
-			*dest++ = 0x80 + ((*source >> 6) & 0x3f);
-			*dest++ = 0x80 + (*source & 0x3f);
-			destLength -= 5;
-		} else { /* 31 bits */
-			*dest++ = 0xfc + (*source >> 30);
-			*dest++ = 0x80 + ((*source >> 24) & 0x3f);
-			*dest++ = 0x80 + ((*source >> 18) & 0x3f);
-			*dest++ = 0x80 + ((*source >> 12) & 0x3f);
-			*dest++ = 0x80 + ((*source >> 6) & 0x3f);
-			*dest++ = 0x80 + (*source & 0x3f);
-			destLength -= 6;
-		}
-		if (destLength < 1) {
-			// fprintf(stderr, "Length overrun in wide_utf8\n");
-			exit(1);
+		} else if (c < 0x80) {	/* 7 bits */
+			if (dest == destEnd) { error = utf8Overflow; break; }
+			*dest++ = c;
+		} else if (c < 0x800) {	/* 11 bits */
+			if (destEnd - dest < 2) { error = utf8Overflow; break; }
+			*dest++ = 0xc0 + (c >> 6);
+			*dest++ = 0x80 + (c & 0x3f);
+		} else if (c < 0x10000) {	/* 16 bits */
+			if (c >= 0xd800 && c <= 0xdfff) { error = utf8Invalid; break; }
+			if (destEnd - dest < 3) { error = utf8Overflow; break; }
+			*dest++ = 0xe0 + (c >> 12);
+			*dest++ = 0x80 + ((c >> 6) & 0x3f);
+			*dest++ = 0x80 + (c & 0x3f);
+		} else if (c <= 0x10ffff) {	/* 21 bits */
+			if (destEnd - dest < 4) { error = utf8Overflow; break; }
+			*dest++ = 0xf0 + (c >> 18);
+			*dest++ = 0x80 + ((c >> 12) & 0x3f);
+			*dest++ = 0x80 + ((c >> 6) & 0x3f);
+			*dest++ = 0x80 + (c & 0x3f);
+		} else { // beyond Unicode
+			error = utf8Invalid;
+			break;
 		}
-	} // for
+	} // one wide_t
 	*dest++ = 0; // terminating null
+	if (error) {
+		if (errorPosition) *errorPosition = index;
+		return(error);
+	}
 	return(dest - oldDest);
 } // wide_utf8
 
+int wide_utf8(utf8_t *dest, int destLength, const wide_t *source,
+		int sourceLength){
+	return(wide_utf8(dest, destLength, source, sourceLength, NULL));
+} // wide_utf8
+
 utf8_t printBuf[LINELEN];
 
-// the returned value is static, so you cannot have two outstanding
+// the returned value is static, so you cannot have two outstanding.  A string
+// that does not fit, or is not valid Unicode, is cut short.
 utf8_t *makeUTF(const wide_t *source, int sourceLength){
 	wide_utf8(printBuf, LINELEN, source, sourceLength);
 	return printBuf;
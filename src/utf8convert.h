@@ -7,9 +7,32 @@
 #ifndef UTF8CONVERT_H
 #define UTF8CONVERT_H
 
+// error codes of the validating conversions
+static const int utf8Invalid = -1; // the source is not valid UTF-8 or Unicode
+static const int utf8Overflow = -2; // the destination is too short
+
 int utf8_wide(wide_t *dest, const utf8_t *source, const int outLength);
+int utf8_wide(wide_t *dest, const utf8_t *source, int sourceLength,
+	const int outLength);
+	// the source need not be null-terminated; sourceLength is in bytes.  An
+	// invalid byte sequence becomes its first byte, as is; the result is
+	// truncated to fewer than outLength wide characters.
+int utf8_wide(wide_t *dest, const utf8_t *source, int sourceLength,
+	const int outLength, int *errorPosition);
+	// validating form: returns the number of wide characters (at most
+	// outLength), or utf8Invalid or utf8Overflow, with the byte offset of the
+	// offending character in *errorPosition unless errorPosition is NULL.
+int utf8_count(const utf8_t *source, int sourceLength);
+	// the number of characters in source, or utf8Invalid if it is not valid
+	// UTF-8.  Nothing is converted.
 int wide_utf8(utf8_t *dest, int destLength, const wide_t *source,
 	int sourceLength);
+int wide_utf8(utf8_t *dest, int destLength, const wide_t *source,
+	int sourceLength, int *errorPosition);
+	// returns the number of bytes, including the null, or utf8Invalid or
+	// utf8Overflow, with the index of the offending wide_t in *errorPosition
+	// unless errorPosition is NULL.  dest is null-terminated in any case,
+	// unless destLength is 0.
 extern utf8_t *makeUTF(const wide_t *source, int sourceLength);
 
 #endif
@@ -0,0 +1,75 @@
+// wordhash.cpp
+// license: Gnu Public License.
+//
+// The goodWordTable keys words by their UTF-8 form, so both backends hash
+// bytes.
+//
+// multiplyHash() follows the design of wyhash by Wang Yi: the bytes are taken
+// as 64-bit lanes, each pair of lanes is XORed with constants and folded by
+// one 64x64->128-bit multiplication, and the state is folded once more with
+// the length.  Up to 16 bytes, the usual case, are read as two possibly
+// overlapping pairs of lanes with no loop at all.  Jenkins' hash() mixes
+// three 32-bit lanes with a dozen shifts, subtractions and XORs per round;
+// one multiplication does the work of those for 16 bytes.  The lookup2
+// backend is hashlong(), which keeps two of hash()'s lanes for 64 bits.
+//
+// 	read8, read4: lanes of bytes, in the byte order of the machine
+// 	multiplyHash: the wide-multiplication hash
+// 	wordHash: dispatch to a backend
+
+#include <string.h>
+#include "wordhash.h"
+#include "lookup2.h"
+
+const char *backendNames[hashBackends] = {"lookup2", "multiply"};
+
+static const __uint64_t secret0 = 0xa0761d6478bd642fULL;
+static const __uint64_t secret1 = 0xe7037ed1a0b428dbULL;
+static const __uint64_t secret2 = 0x8ebc6af09c88c6e3ULL;
+static const __uint64_t secret3 = 0x589965cc75374cc3ULL;
+
+static inline __uint64_t read8(const utf8_t *bytes) {
+	__uint64_t answer;
+	memcpy(&answer, bytes, 8);
+	return(answer);
+} // read8
+
+static inline __uint64_t read4(const utf8_t *bytes) {
+	__uint32_t answer;
+	memcpy(&answer, bytes, 4);
+	return(answer);
+} // read4
+
+__uint64_t multiplyHash(const utf8_t *string, const int length) {
+	__uint64_t state = secret0 ^ length, first, second;
+	int index, middle;
+	if (length <= 16) {
+		if (length >= 4) { // the first and last 4 bytes, and two more
+			middle = (length >> 3) << 2; // 0 or 4
+			first = (read4(string) << 32) | read4(string + middle);
+			second = (read4(string + length - 4) << 32) |
+				read4(string + length - 4 - middle);
+		} else if (length > 0) { // 1 to 3 bytes
+			first = (static_cast<__uint64_t>(string[0]) << 16) |
+				(string[length >> 1] << 8) | string[length - 1];
+			second = 0;
+		} else {
+			first = second = 0;
+		}
+	} else {
+		for (index = 0; index + 16 < length; index += 16) {
+			state = multiplyFold(read8(string + index) ^ secret1,
+				read8(string + index + 8) ^ state);
+		}
+		first = read8(string + length - 16); // overlaps the loop, if need be
+		second = read8(string + length - 8);
+	}
+	return(multiplyFold(secret1 ^ length,
+		multiplyFold(first ^ secret2, second ^ state ^ secret3)));
+} // multiplyHash
+
+__uint64_t wordHash(const utf8_t *string, const int length,
+		const int backend) {
+	if (backend == multiplyBackend) return(multiplyHash(string, length));
+	return(hashlong(string, length, 1));
+} // wordHash
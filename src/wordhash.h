@@ -0,0 +1,36 @@
+// wordhash.h
+// license: Gnu Public License.
+//
+// The hash backends of the uspell package.  A backend hashes the UTF-8 form of
+// whole words for the goodWordTable and finishes the polynomial hashes of
+// rollhash.cpp for the reducedWordTable.  An instance of uSpell uses one
+// backend for all its tables, chosen by the multiplyHash initializer flag.
+
+#ifndef WORDHASH_H
+#define WORDHASH_H
+
+#include "mytypes.h"
+
+enum {
+	lookup2Backend = 0, // Jenkins' hashlong(), and the finalizer of Murmur3
+	multiplyBackend = 1, // multiplyHash(), and multiplyFold()
+	hashBackends = 2 // how many there are
+};
+
+extern const char *backendNames[hashBackends];
+
+__uint64_t multiplyHash(const utf8_t *string, const int length);
+	// 64-bit hash by wide multiplication, 16 bytes at a time
+__uint64_t wordHash(const utf8_t *string, const int length,
+	const int backend);
+	// 64-bit hash of string, of length bytes, by the given backend
+
+// The two halves of the 128-bit product of a and b, XORed together.  Every bit
+// of a and b affects the high half.
+static inline __uint64_t multiplyFold(const __uint64_t a, const __uint64_t b) {
+	__uint128_t product = static_cast<__uint128_t>(a) * b;
+	return(static_cast<__uint64_t>(product) ^
+		static_cast<__uint64_t>(product >> 64));
+} // multiplyFold
+
+#endif // WORDHASH_H